@@ -0,0 +1,133 @@
+/**
+ * @file metrics_insert.cpp
+ * @author Alexander N. Pillai
+ * @brief Measures how many metric rows per second are written to an experiment
+ *        database by formatted SQL text (one statement per day) and by the
+ *        prepared multi-row inserts of DatabaseHandler::insert_metrics.
+ *
+ * usage: metrics_insert tomefile [sim_duration] [particles] [pop_size]
+ *
+ * @copyright TBD
+ */
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/simulator.hpp>
+#include <storyteller/ledger.hpp>
+#include <storyteller/database_handler.hpp>
+#include <storyteller/database_connection.hpp>
+#include <storyteller/utility.hpp>
+
+namespace fs = std::filesystem;
+
+// the write path used before prepared inserts: one formatted statement per day
+static void insert_metrics_as_text(SQLite::Database& db, size_t serial, const Ledger* ledger, size_t n_days) {
+    std::stringstream sql;
+    for (size_t t = 0; t < n_days; ++t) {
+        sql << "INSERT INTO met "
+            << "(serial,time,c_vax_flu_inf,c_vax_nonflu_inf,c_unvax_flu_inf,c_unvax_nonflu_inf,c_vax_flu_mai,c_vax_nonflu_mai,c_unvax_flu_mai,c_unvax_nonflu_mai,tnd_ve_est)"
+            << " VALUES ("
+            << serial << ","
+            << t << ","
+            << ledger->get_cumul_infs(VACCINATED, INFLUENZA, t) << ","
+            << ledger->get_cumul_infs(VACCINATED, NON_INFLUENZA, t) << ","
+            << ledger->get_cumul_infs(UNVACCINATED, INFLUENZA, t) << ","
+            << ledger->get_cumul_infs(UNVACCINATED, NON_INFLUENZA, t) << ","
+            << ledger->get_cumul_mais(VACCINATED, INFLUENZA, t) << ","
+            << ledger->get_cumul_mais(VACCINATED, NON_INFLUENZA, t) << ","
+            << ledger->get_cumul_mais(UNVACCINATED, INFLUENZA, t) << ","
+            << ledger->get_cumul_mais(UNVACCINATED, NON_INFLUENZA, t) << ","
+            << ledger->get_tnd_ve_est(t) << ");";
+        db.exec(sql.str());
+        sql.str(std::string());
+    }
+}
+
+// number of rows and order-independent total of the integer metrics of a range of serials
+static std::pair<long long, double> metrics_checksum(SQLite::Database& db, size_t first_serial, size_t last_serial) {
+    SQLite::Statement query(db, "SELECT COUNT(*), TOTAL(time + c_vax_flu_inf + c_vax_nonflu_inf + c_unvax_flu_inf + c_unvax_nonflu_inf"
+                                " + c_vax_flu_mai + c_vax_nonflu_mai + c_unvax_flu_mai + c_unvax_nonflu_mai)"
+                                " FROM met WHERE serial >= ? AND serial < ?");
+    query.bind(1, (long long) first_serial);
+    query.bind(2, (long long) last_serial);
+    query.executeStep();
+    return {query.getColumn(0).getInt64(), query.getColumn(1).getDouble()};
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " tomefile [sim_duration] [particles] [pop_size]\n";
+        return 1;
+    }
+
+    const std::string tome_path = argv[1];
+    const double sim_duration   = (argc > 2) ? std::stod(argv[2]) : 3650;
+    const size_t n_particles    = (argc > 3) ? std::stoul(argv[3]) : 100;
+    const double pop_size       = (argc > 4) ? std::stod(argv[4]) : 1e4;
+
+    sol::state lua_vm;
+    Tome tome(&lua_vm, tome_path);
+
+    // one (small) epidemic supplies the metrics written for every particle
+    RngHandler rng_handler;
+    Parameters par(&rng_handler, nullptr, &tome);
+    par.read_default_parameters({{"sim_duration", sim_duration}, {"pop_size", pop_size}, {"seed", 1}});
+    Simulator simulator(&par, nullptr, &rng_handler);
+    simulator.init();
+    simulator.simulate();
+    simulator.results();
+    const Ledger* ledger = simulator.get_ledger();
+    const size_t n_days  = par.get(SIM_DURATION);
+
+    const auto database_path = (fs::temp_directory_path() / "storyteller_metrics_insert.sqlite").string();
+    for (const auto& suffix : {"", "-wal", "-shm"}) { fs::remove(database_path + suffix); }
+
+    auto connection = DatabaseConnection::for_path(database_path);
+    auto& db = connection->database(true);
+    db.exec("CREATE TABLE met (serial INT, time INT, c_vax_flu_inf INT, c_vax_nonflu_inf INT, c_unvax_flu_inf INT,"
+            " c_unvax_nonflu_inf INT, c_vax_flu_mai INT, c_vax_nonflu_mai INT, c_unvax_flu_mai INT,"
+            " c_unvax_nonflu_mai INT, tnd_ve_est REAL)");
+
+    // each method writes its own range of serials, one transaction per particle
+    auto time_method = [&](size_t first_serial, const std::function<void(size_t)>& write) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t p = 0; p < n_particles; ++p) {
+            SQLite::Transaction transaction(db);
+            write(first_serial + p);
+            transaction.commit();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    };
+
+    const double text_seconds = time_method(0, [&](size_t serial) {
+        insert_metrics_as_text(db, serial, ledger, n_days);
+    });
+    const double prepared_seconds = time_method(n_particles, [&](size_t serial) {
+        DatabaseHandler::insert_metrics(connection, MetricsBlock(serial, ledger, n_days));
+    });
+
+    const double n_rows = (double) n_days * n_particles;
+    std::cout << "method,rows,seconds,rows_per_second,speedup\n"
+              << "text," << n_rows << ',' << text_seconds << ',' << n_rows / text_seconds << ",1\n"
+              << "prepared," << n_rows << ',' << prepared_seconds << ',' << n_rows / prepared_seconds << ','
+              << text_seconds / prepared_seconds << '\n';
+
+    const bool identical = (metrics_checksum(db, 0, n_particles) == metrics_checksum(db, n_particles, 2 * n_particles));
+    if (not identical) {
+        std::cerr << "ERROR: prepared inserts wrote different metrics than formatted SQL\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
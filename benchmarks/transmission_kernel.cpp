@@ -0,0 +1,76 @@
+/**
+ * @file transmission_kernel.cpp
+ * @author Alexander N. Pillai
+ * @brief Times each instruction set of the transmission kernel on a batch of
+ *        exposures and checks that they all produce the scalar outcomes.
+ *
+ * usage: transmission_kernel [n_exposures] [repetitions]
+ *
+ * @copyright TBD
+ */
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <storyteller/transmission_kernel.hpp>
+#include <storyteller/utility.hpp>
+
+int main(int argc, char* argv[]) {
+    const size_t n    = (argc > 1) ? std::stod(argv[1]) : 1e7;
+    const size_t reps = (argc > 2) ? std::stoul(argv[2]) : 10;
+
+    RngHandler rng;
+    rng.set_seed(1);
+
+    // a mix of susceptible, immune, vaccinated and unvaccinated exposures
+    std::vector<double> suscep(n), protection(n), pr_sympt(n), pr_care(n), u(3 * n);
+    rng.fill_uniform(INFECTION, suscep.data(), n);
+    rng.fill_uniform(VACCINATION, protection.data(), n);
+    rng.fill_uniform(BEHAVIOR, pr_sympt.data(), n);
+    rng.fill_uniform(BEHAVIOR, pr_care.data(), n);
+    rng.fill_uniform(INFECTION, u.data(), u.size());
+    for (size_t i = 0; i < n; i += 7) { suscep[i] = 0.0; }
+    for (size_t i = 0; i < n; i += 2) { protection[i] = 0.0; }
+
+    std::vector<uint8_t> reference(n);
+    std::cout << "isa,seconds_per_batch,speedup,identical\n";
+    double scalar_seconds = 0.0;
+    bool all_identical = true;
+    for (size_t isa = 0; isa < NUM_KERNEL_ISAS; ++isa) {
+        if (not transmission_kernel::is_supported((KernelIsa) isa)) continue;
+
+        std::vector<uint8_t> outcomes(n);
+        const InfectionBatch batch = {
+            n, suscep.data(), protection.data(), pr_sympt.data(), pr_care.data(),
+            u.data(), u.data() + n, u.data() + 2 * n, outcomes.data()
+        };
+
+        transmission_kernel::evaluate(batch, (KernelIsa) isa); // warm up
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t r = 0; r < reps; ++r) {
+            transmission_kernel::evaluate(batch, (KernelIsa) isa);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double seconds = elapsed.count() / reps;
+
+        if (isa == SCALAR) {
+            scalar_seconds = seconds;
+            reference = outcomes;
+        }
+        const bool identical = (outcomes == reference);
+        all_identical = all_identical and identical;
+
+        std::cout << transmission_kernel::isa_name((KernelIsa) isa) << ','
+                  << seconds << ','
+                  << scalar_seconds / seconds << ','
+                  << identical << '\n';
+    }
+
+    if (not all_identical) {
+        std::cerr << "ERROR: vectorized outcomes differ from the scalar kernel\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
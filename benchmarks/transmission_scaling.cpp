@@ -0,0 +1,90 @@
+/**
+ * @file transmission_scaling.cpp
+ * @author Alexander N. Pillai
+ * @brief Measures how the parallel transmission mode scales from 1 to N threads
+ *        and checks that every thread count produces the same epidemic.
+ *
+ * usage: transmission_scaling tomefile [max_threads] [pop_size] [seed]
+ *
+ * @copyright TBD
+ */
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/simulator.hpp>
+#include <storyteller/population.hpp>
+#include <storyteller/person.hpp>
+#include <storyteller/thread_pool.hpp>
+#include <storyteller/utility.hpp>
+
+// order-independent summary of the final population state
+static size_t epidemic_checksum(Population* pop) {
+    size_t checksum = 0;
+    for (size_t i = 0; i < pop->size(); ++i) {
+        const auto p = (*pop)[i];
+        for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+            const auto strain = (StrainType) s;
+            checksum += (i + 1) * (p.infection_count(strain) * 31 + p.last_infection_time(strain));
+        }
+    }
+    return checksum;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " tomefile [max_threads] [pop_size] [seed]\n";
+        return 1;
+    }
+
+    const std::string tome_path = argv[1];
+    const size_t max_threads = (argc > 2) ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    const double pop_size    = (argc > 3) ? std::stod(argv[3]) : 1e6;
+    const double seed        = (argc > 4) ? std::stod(argv[4]) : 1;
+
+    sol::state lua_vm;
+    Tome tome(&lua_vm, tome_path);
+
+    std::cout << "threads,seconds,speedup,checksum\n";
+    double serial_seconds = 0.0;
+    size_t reference_checksum = 0;
+    for (size_t n_threads = 1; n_threads <= max_threads; ++n_threads) {
+        RngHandler rng_handler;
+        Parameters par(&rng_handler, nullptr, &tome);
+        par.read_default_parameters({{"pop_size", pop_size}, {"seed", seed}});
+
+        ThreadPool pool(n_threads);
+        Simulator simulator(&par, nullptr, &rng_handler);
+        simulator.set_thread_pool(&pool);
+        simulator.init();
+
+        const auto start = std::chrono::steady_clock::now();
+        simulator.simulate();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto checksum = epidemic_checksum(simulator.get_population());
+        if (n_threads == 1) {
+            serial_seconds     = elapsed.count();
+            reference_checksum = checksum;
+        }
+
+        std::cout << n_threads << ','
+                  << elapsed.count() << ','
+                  << serial_seconds / elapsed.count() << ','
+                  << checksum << '\n';
+
+        if (checksum != reference_checksum) {
+            std::cerr << "ERROR: results with " << n_threads << " threads differ from 1 thread\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -10,10 +10,74 @@ Tome["experiment_description"] = "This is the default example for the Storytelle
 Tome["database_path"] = "default.sqlite"
 Tome["output_dir_path"] = "out"
 
+-- DATABASE
+-- SQLite journal mode of the experiment database (WAL by default); WAL needs
+-- shared memory, so use "DELETE" if the database is on a network filesystem
+-- Tome["database_journal_mode"] = "WAL"
+-- outside of the hpc mode, a background thread commits the results of up to
+-- database_group_size particles per transaction (0 makes every particle commit
+-- its own), waiting at most database_group_seconds, and holding at most
+-- database_writer_megabytes of results that are not yet committed
+-- Tome["database_group_size"] = 16
+-- Tome["database_group_seconds"] = 10
+-- Tome["database_writer_megabytes"] = 256
+
 -- GLOBAL PARAMETERS
 Tome["n_realizations"] = 10
 Tome["par_value_tolerance"] = 1e-10
 
+-- PARALLEL TRANSMISSION
+-- number of threads used for transmission (0 = serial); --threads takes precedence
+-- results for a given seed are identical for any number of threads > 0
+-- Tome["threads"] = 0
+
+-- ENSEMBLES
+-- max number of realizations of a particle simulated together in lockstep
+-- (1 = one at a time); --ensemble takes precedence
+-- Tome["ensemble_size"] = 1
+
+-- PARALLEL BATCH
+-- number of particles (or ensembles) of a batch simulated concurrently, each
+-- on its own thread with serial transmission (1 = one at a time); --workers
+-- takes precedence
+-- Tome["workers"] = 1
+
+-- POPULATION REUSE
+-- max number of synthesized populations kept so that particles with the same
+-- population parameters and seed skip synthesis (0 = always synthesize); defaults
+-- to ensemble_size * workers; --pop-cache takes precedence
+-- Tome["population_cache_size"] = 1
+
+-- CHECKPOINTS
+-- days between checkpoints of each running simulation (0 = none); when enabled,
+-- SIGTERM also checkpoints and stops the batch, and --resume continues from the
+-- latest checkpoints; --checkpoint takes precedence
+-- Tome["checkpoint_interval"] = 0
+
+-- SYNTHETIC POPULATION FILE
+-- binary population written by --gen-synth-pop (synthpop.bin next to the tome)
+-- that every simulation loads instead of synthesizing its own; it must match the
+-- population size and synthesis parameters; --synthpop takes precedence
+-- Tome["synthpop_path"] = "synthpop.bin"
+
+-- BRANCHING
+-- particles that only differ in care-seeking, symptom, exposure, or seasonal
+-- parameters simulate their first branch_day days once, with the parameters of
+-- the first of them, and then fork (0 = no branching); up to `workers` branches
+-- run at once; --branch-day takes precedence
+-- Tome["branch_day"] = 0
+
+-- RANDOM NUMBER GENERATOR
+-- "philox" (default) or "mt19937" for the GSL Mersenne Twister; either way,
+-- draws are consumed in batches, so results differ from versions that drew one
+-- value at a time; --rng takes precedence
+-- Tome["rng_backend"] = "philox"
+
+-- COMMON RANDOM NUMBERS
+-- key every random decision by (seed, agent, day, purpose) so that particles
+-- sharing a seed see the same randomness; --crn takes precedence
+-- Tome["common_random_numbers"] = false
+
 -- CONFIGURATION TABLE OF CONTENTS
 Tome["parameters"] = "config/parameters.lua"
 Tome["metrics"] = "config/metrics.lua"
\ No newline at end of file
@@ -0,0 +1,66 @@
+/**
+ * @file arena.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the SimulationArena class that provides the memory used by the
+ *        population, infection records, and ledger of a simulation.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * @brief Monotonic memory arena for all per-simulation storage.
+ *
+ * Allocations are bump-allocated out of a single retained buffer and individual
+ * deallocations are no-ops, so tearing a simulation down is a single rewind of
+ * the arena. Any memory that had to be requested beyond the retained buffer is
+ * folded into the buffer on the next rewind, so that after the first particle of
+ * a batch the arena no longer needs to go to the system allocator at all.
+ */
+class SimulationArena {
+  public:
+    SimulationArena(size_t initial_bytes = 0);
+    ~SimulationArena();
+
+    /**
+     * @brief Get the memory resource that simulation containers allocate from.
+     */
+    std::pmr::memory_resource* get_resource();
+
+    /**
+     * @brief Release everything allocated since the last rewind.
+     *
+     * Must only be called once every container using the arena is destroyed.
+     */
+    void rewind();
+
+    size_t get_capacity() const;
+    size_t get_high_water_mark() const;
+
+  private:
+    /**
+     * @brief Upstream resource that records how much the arena overflowed.
+     */
+    class OverflowResource : public std::pmr::memory_resource {
+      public:
+        size_t bytes_allocated = 0;
+
+      private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void reserve(size_t bytes);
+
+    std::unique_ptr<std::byte[]> buffer;
+    size_t capacity;
+    size_t high_water_mark;
+
+    OverflowResource overflow;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> resource;
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+/**
+ * @file batch_worker.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the BatchWorker object that simulates particles of a batch on
+ *        its own thread.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "parameter_set.hpp"
+
+class Storyteller;
+class ParticleJob;
+class RngHandler;
+class DatabaseHandler;
+class Parameters;
+class Ensemble;
+class SimulationArena;
+class PopulationCache;
+class SynthpopFile;
+
+/**
+ * @brief Simulates particles of a batch independently of the other workers.
+ *
+ * Setting up and simulating a particle never calls into Lua (parameter values
+ * were validated when the experiment database was initialized), so workers
+ * share the Storyteller's Tome. Each worker owns the simulation context that
+ * its particles reuse (see Storyteller::init_simulation_context): one
+ * RngHandler and DatabaseHandler per realization, the Parameters, and an
+ * Ensemble created for the batch's largest particle. Workers also share the
+ * batch's parameter sets and jobs (which they only read, or update at their own
+ * indices), the PopulationCache (which locks itself), and the writer mutex that
+ * serializes every database and output file operation.
+ */
+class BatchWorker {
+  public:
+    BatchWorker(const Storyteller* storyteller, std::map<std::string, bool> flags,
+                std::string backend, std::mutex* writer_mutex, PopulationCache* cache = nullptr);
+    ~BatchWorker();
+
+    void set_checkpoint_interval(size_t days);
+    void set_synthpop(const SynthpopFile* file);
+    void set_ensemble_size(size_t n_realizations);
+
+    bool run(const int serial_start, const std::vector<size_t>& indices,
+             const std::vector<ParameterSet>& batch_parsets, std::vector<ParticleJob>& jobs);
+
+  private:
+    void init_simulation_context(const int serial_start, const std::vector<ParameterSet>& batch_parsets);
+
+    const Storyteller* owner;
+    std::map<std::string, bool> simulation_flags;
+    std::string rng_backend;
+    std::mutex* writer;                     ///< held while writing results
+    PopulationCache* population_cache;      ///< shared by every worker (may be null)
+    size_t checkpoint_interval;             ///< days between checkpoints (0 for none)
+    const SynthpopFile* synthpop;           ///< shared, read-only (may be null)
+    size_t ensemble_size;                   ///< most realizations simulated together
+
+    std::unique_ptr<SimulationArena> arena;                    ///< holds the storage of #ensemble
+    std::vector<std::unique_ptr<RngHandler>> rng_handlers;     ///< [realization] reseeded for every ensemble
+    std::vector<std::unique_ptr<DatabaseHandler>> db_handlers; ///< [realization] (none in the hpc mode)
+    std::unique_ptr<Parameters> parameters;                    ///< overwritten for every ensemble
+    std::unique_ptr<Ensemble> ensemble;                        ///< reset for every ensemble
+};
\ No newline at end of file
@@ -0,0 +1,138 @@
+/**
+ * @file checkpoint.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the binary reader and writer used to checkpoint a running
+ *        simulation, and the SIGTERM handling that triggers a final checkpoint.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace checkpoint {
+
+/**
+ * @brief Return code of a batch that stopped early after checkpointing on SIGTERM.
+ */
+constexpr int INTERRUPTED_RETURN_CODE = 128 + SIGTERM;
+
+/**
+ * @brief Fixed-size record at the start of every checkpoint file.
+ *
+ * A checkpoint is only restored into a simulation of the same particle, seed,
+ * and modes; only #sim_time is expected to differ.
+ */
+struct Header {
+    static constexpr uint32_t MAGIC   = 0x4b435453; // "STCK"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t serial;
+    uint64_t seed;
+    uint64_t pop_size;
+    uint64_t sim_duration;
+    uint64_t sim_time;            ///< first day that has not been simulated
+    uint32_t rng_backend;
+    uint32_t common_random_numbers;
+    uint64_t n_chunks;            ///< 0 in the serial transmission mode
+
+    bool is_compatible(const Header& other) const;
+};
+
+/**
+ * @brief Writes a checkpoint file.
+ *
+ * Everything is written to a temporary file that only replaces the previous
+ * checkpoint when commit() is called, so a simulation interrupted while
+ * writing still has its last complete checkpoint.
+ */
+class Writer {
+  public:
+    Writer(const std::filesystem::path& path);
+    ~Writer();
+
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values are written as is");
+        write_bytes(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Writes the length of the vector followed by its elements (vectors of
+     *        vectors are written recursively).
+     */
+    template<typename T, typename Alloc>
+    void write(const std::vector<T, Alloc>& values) {
+        write(values.size());
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            write_bytes(values.data(), values.size() * sizeof(T));
+        } else {
+            for (const auto& v : values) { write(v); }
+        }
+    }
+
+    void write(const std::string& value);
+
+    void write_bytes(const void* data, size_t n_bytes);
+    void commit();
+
+  private:
+    std::filesystem::path path;
+    std::filesystem::path tmp_path;
+    std::ofstream out;
+};
+
+/**
+ * @brief Reads a checkpoint file in the order it was written. A truncated or
+ *        unreadable file is a fatal error.
+ */
+class Reader {
+  public:
+    Reader(const std::filesystem::path& path);
+    ~Reader() = default;
+
+    template<typename T>
+    void read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values are read as is");
+        read_bytes(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Reads a vector written by Writer::write, resizing it (with its own
+     *        allocator) to the written length.
+     */
+    template<typename T, typename Alloc>
+    void read(std::vector<T, Alloc>& values) {
+        size_t n = 0;
+        read(n);
+        values.resize(n);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            read_bytes(values.data(), n * sizeof(T));
+        } else {
+            for (auto& v : values) { read(v); }
+        }
+    }
+
+    void read(std::string& value);
+
+    void read_bytes(void* data, size_t n_bytes);
+
+  private:
+    std::filesystem::path path;
+    std::ifstream in;
+};
+
+Header read_header(const std::filesystem::path& path);
+
+void install_termination_handler();
+bool termination_requested();
+
+} // namespace checkpoint
\ No newline at end of file
@@ -10,11 +10,25 @@
 
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <cstdint>
+
+#include <gsl/gsl_rng.h>
+
+#include "eligible_agents.hpp"
+#include "transmission_kernel.hpp"
 
 class Person;
+class Population;
 class Parameters;
 class RngHandler;
 class Ledger;
+class LedgerTally;
+class ThreadPool;
+class PopulationCache;
+class SynthpopFile;
+struct Exposure;
+namespace checkpoint { class Writer; class Reader; }
 
 /**
  * @brief Object that stores and manipulates a synthetic population for a single
@@ -22,23 +36,88 @@ class Ledger;
  */
 class Community {
   friend class Simulator;
+  friend class Ensemble;
   public:
-    Community(const Parameters* parameters, const RngHandler* rng_handler);
+    Community(const Parameters* parameters, const RngHandler* rng_handler,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~Community();
 
+    void reset();
+
     void transmission(size_t time);
 
-    std::vector<Person*> get_population() const;
+    void set_thread_pool(ThreadPool* thread_pool);
+    void set_population_cache(PopulationCache* cache);
+    void set_parameters(const Parameters* parameters);
+    void set_synthpop(const SynthpopFile* file);
+
+    Population* get_population() const;
+    size_t get_n_chunks() const;
+
+    /**
+     * @brief Number of agents in each chunk of a parallel transmission step.
+     *
+     * Fixed (rather than derived from the thread count) so that the chunks, and
+     * therefore the random number streams, are the same for any number of threads.
+     */
+    static constexpr size_t TRANSMISSION_CHUNK_SIZE = 1 << 16;
 
   private:
+    /**
+     * @brief Exposed agents' state and draws gathered into contiguous arrays for
+     *        the transmission kernel, reused from day to day.
+     */
+    struct ExposureBatch {
+        std::vector<double> susceptibility;
+        std::vector<double> vaccine_protection;
+        std::vector<double> pr_symptoms;
+        std::vector<double> pr_careseeking;
+        std::vector<double> u_infection;
+        std::vector<double> u_symptoms;
+        std::vector<double> u_careseeking;
+        std::vector<uint8_t> outcomes;
+
+        void resize(size_t n);
+        InfectionBatch view();
+    };
+
     void init_population();
-    void vaccinate_population(size_t time);
+    void resize_chunks();
+    void synthesize_population(size_t time);
     void init_susceptibilities();
-    
-    std::vector<std::unique_ptr<Person>> people;
-    std::vector<Person*> susceptibles;
+    void init_eligible_agents();
+    bool is_permanently_immune(size_t agent) const;
+    void retire_infected(EligibleAgents& eligible_agents, const Exposure& exposure, size_t time);
+    void parallel_transmission(size_t time);
+    size_t sample_exposures(size_t time);
+    void sample_keyed_exposures(size_t time, const std::pmr::vector<size_t>& candidates, std::pmr::vector<Exposure>& exposed) const;
+    void stage_exposures(const std::pmr::vector<Exposure>& exposed, size_t time, gsl_rng* infection_stream,
+                         gsl_rng* behavior_stream, ExposureBatch& batch, size_t offset);
+    void apply_outcomes(size_t time, const uint8_t* outcomes);
+    void save_state(checkpoint::Writer& out) const;
+    void load_state(checkpoint::Reader& in);
+
+    std::unique_ptr<Population> population;
+    std::unique_ptr<EligibleAgents> eligible; // agents that can currently be infected
+    std::vector<size_t> refractory_days;      // [strain] whole days an agent is parked after infection
+    std::pmr::vector<Exposure> exposures; // reused by transmission() every day
+    std::pmr::vector<uint8_t> chosen;     // [candidate] scratch of Parameters::sample_daily_exposures
+    ExposureBatch batch;                  // reused by transmission() every day
+
+    // parallel transmission state (only used when a ThreadPool is set)
+    ThreadPool* pool;
+    std::vector<gsl_rng*> chunk_rngs;                       // [chunk]
+    std::vector<EligibleAgents> chunk_eligible;              // [chunk]
+    std::vector<std::pmr::vector<Exposure>> chunk_exposures; // [chunk]
+    std::vector<std::pmr::vector<uint8_t>> chunk_chosen;     // [chunk]
+    std::vector<ExposureBatch> chunk_batches;                // [chunk]
+    std::vector<LedgerTally> chunk_tallies;                  // [chunk]
+
+    PopulationCache* population_cache;    // null unless synthesized populations are reused
+    const SynthpopFile* synthpop;         // null unless the population is loaded from a file
 
     std::unique_ptr<Ledger> ledger;
     const Parameters* par;
     const RngHandler* rng;
+    std::pmr::memory_resource* mem;
 };
\ No newline at end of file
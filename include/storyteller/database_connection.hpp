@@ -0,0 +1,82 @@
+/**
+ * @file database_connection.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the DatabaseConnection that keeps one long-lived SQLite
+ *        connection to the experiment database per process.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <string>
+
+#include <sys/types.h>
+
+namespace SQLite { class Database; class Statement; }
+
+/**
+ * @brief Shared, lazily opened connection to an experiment database.
+ *
+ * Every DatabaseHandler in a process that uses the same database shares one
+ * connection (see for_path), which keeps a cache of prepared statements. The
+ * connection uses the journal mode given by the Tome (WAL by default), and
+ * waits for locks held by other processes in a busy handler that backs off
+ * exponentially with jitter. A forked child (see Storyteller::branch_simulation)
+ * never uses its parent's connection and opens its own.
+ */
+class DatabaseConnection {
+  public:
+    /**
+     * @brief Number of connections opened and time spent waiting for locks.
+     */
+    struct Counters {
+        size_t opens          = 0; ///< connections opened (including after a fork)
+        size_t prepares       = 0; ///< statements prepared
+        size_t cache_hits     = 0; ///< prepared statements reused
+        size_t busy_waits     = 0; ///< waits for a lock held by another connection
+        size_t retries        = 0; ///< operations retried after failing
+        double ms_lock_wait   = 0; ///< time spent waiting for locks (and before retries)
+    };
+
+    ~DatabaseConnection();
+
+    static DatabaseConnection* for_path(const std::string& database_path);
+    static void report_counters(std::ostream& out);
+
+    void set_journal_mode(const std::string& mode);
+
+    SQLite::Database& database(bool create = false);
+    SQLite::Statement& statement(const std::string& sql);
+
+    std::recursive_mutex& get_mutex();
+    void backoff(size_t attempt);
+
+    Counters get_counters() const;
+
+  private:
+    DatabaseConnection(const std::string& database_path);
+
+    static int busy_handler(void* connection, int n_prior_calls);
+    double jittered_delay_ms(size_t attempt, double max_ms);
+
+    std::string path;
+    std::string journal_mode;
+    pid_t owner_pid;                    ///< process that opened #db
+
+    std::unique_ptr<SQLite::Database> db;
+    std::map<std::string, std::unique_ptr<SQLite::Statement>> statements; // sql -> prepared statement
+
+    mutable std::recursive_mutex mutex; ///< held for the duration of every DatabaseHandler operation
+    std::minstd_rand jitter;            // guarded by #mutex
+    double ms_waited_this_lock;         ///< reset when a busy handler wait starts
+    Counters counters;                  // guarded by #mutex
+
+    static constexpr double BASE_DELAY_MS    = 5.0;
+    static constexpr double MAX_DELAY_MS     = 2000.0;
+    static constexpr double BUSY_TIMEOUT_MS  = 60000.0;
+};
\ No newline at end of file
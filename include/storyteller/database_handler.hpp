@@ -8,13 +8,20 @@
  */
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "parameter_set.hpp"
+
 class Storyteller;
 class Ledger;
 class Parameters;
 class Tome;
+class DatabaseConnection;
+class DatabaseWriter;
 
 enum TableName {
     PAR,
@@ -38,8 +45,6 @@ class ParticleJob {
     void start();
     void end();
 
-    std::string update();
-
     size_t serial;
     size_t attempts;
     size_t completions;
@@ -49,12 +54,34 @@ class ParticleJob {
     int duration;
 };
 
+/**
+ * @brief Copy of the metrics of one simulation, in the order of the met table's
+ *        columns, that outlives the simulation's Ledger.
+ */
+struct MetricsBlock {
+    MetricsBlock() = default;
+    MetricsBlock(size_t serial, const Ledger* ledger, size_t n_days);
+
+    size_t n_days() const;
+    size_t bytes() const;
+
+    size_t serial;
+    bool replace;                   ///< delete the serial's earlier metrics first
+    std::vector<int64_t> counts;    // [day][count], NUM_COUNTS per day
+    std::vector<double> tnd_ve_est; // [day]
+
+    static constexpr size_t NUM_COUNTS = 8; ///< cumulative infections and MAIs by vaccination status and strain
+};
+
 /**
  * @brief Handles all SQLite database operations.
  * 
  * Includes methods that create a new experiment database using the user-provided
  * configuration file, read simulation parameters for a specific particle, and
  * write simulation metrics to the database after a simulation terminates.
+ * Every DatabaseHandler in a process shares the same DatabaseConnection. During a
+ * batch simulation, metrics and job updates are handed to the Storyteller's
+ * DatabaseWriter instead of being committed by the simulation's own thread.
  */
 class DatabaseHandler {
   public:
@@ -66,30 +93,36 @@ class DatabaseHandler {
     bool database_exists();
     bool table_exists(std::string table);
 
-    std::map<std::string, double> read_parameters(unsigned int serial, const std::vector<std::string>& pars);
-    std::vector<std::map<std::string, double>> read_batch_parameters(unsigned int serial_start, unsigned int serial_end, const std::vector<std::string>& pars);
+    ParameterSet read_parameters(unsigned int serial, const ParameterSchema* schema);
+    std::vector<ParameterSet> read_batch_parameters(unsigned int serial_start, unsigned int serial_end, const ParameterSchema* schema);
     void write_metrics(const Ledger* ledger, const Parameters* par);
 
     void start_job(unsigned int serial);
+    void set_job_checkpoint(const std::filesystem::path& path);
     void end_job(unsigned int serial);
     void end_jobs(std::vector<ParticleJob>& jobs);
 
     void drop_table_if_exists(std::string table);
     void import_metrics_from(std::string file_path);
 
+    static std::string metrics_insert_sql(size_t n_rows);
+    static void insert_metrics(DatabaseConnection* connection, const MetricsBlock& metrics);
+    static void update_job(DatabaseConnection* connection, const ParticleJob& job);
+
+    static constexpr size_t MET_ROWS_PER_INSERT = 64; ///< days inserted by one statement
+
   private:
     void create_table();
     void clear_table();
 
     void read_job(unsigned int serial);
 
-    void clear_metrics(unsigned int serial);
-
-    std::vector<std::string> prepare_insert_sql(const Ledger* ledger, const Parameters* par) const;
-
     std::string database_path;
     size_t n_transaction_attempts;
-    size_t ms_delay_between_attempts;
+    DatabaseConnection* connection; ///< shared by every DatabaseHandler in the process
+    DatabaseWriter* writer;         ///< commits metrics and job updates in the background (may be null)
+    std::optional<MetricsBlock> job_metrics; ///< written, but only handed to the #writer with the job's end
+    std::filesystem::path job_checkpoint;    ///< removed once the job's end is committed (empty for none)
 
     const Storyteller* owner;
     const Tome* tome;
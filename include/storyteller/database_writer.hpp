@@ -0,0 +1,94 @@
+/**
+ * @file database_writer.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the DatabaseWriter that commits the metrics and job updates of
+ *        a batch's simulations to the experiment database on its own thread.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "database_handler.hpp"
+
+class DatabaseConnection;
+
+/**
+ * @brief Background writer that groups the updates of many simulations into a
+ *        single transaction.
+ *
+ * Simulations hand their job updates to the writer and carry on; a finished job
+ * is handed over together with its MetricsBlock, as a single update. A single
+ * thread commits everything queued in one transaction once #group_size
+ * simulations' metrics are waiting, or #group_interval after the oldest update
+ * was queued. Updates are committed in the order they were queued, and a
+ * transaction commits all of its updates or none, so a job is never marked done
+ * without its metrics in the database: if the process dies first, or the
+ * transaction is given up on, the job is simply left running (and the writer
+ * remembers that it failed, so the batch does not report success). Likewise, a
+ * job's checkpoint is only removed after its group is committed, so a job that
+ * is left running can still be resumed. Queued updates that are not yet
+ * committed never take up more than #max_bytes (a simulation that would exceed
+ * it waits), and everything queued is committed by flush or before the writer
+ * is destroyed.
+ */
+class DatabaseWriter {
+  public:
+    DatabaseWriter(DatabaseConnection* connection, size_t group_size, double group_seconds,
+                   size_t max_megabytes, bool verbose);
+    ~DatabaseWriter();
+
+    void update_job(const ParticleJob& job);
+    void end_job(MetricsBlock metrics, const ParticleJob& job, std::filesystem::path checkpoint = {});
+    void flush();
+
+    bool failed() const;
+
+  private:
+    /**
+     * @brief Metrics of a finished job, committed in the same transaction as the
+     *        update that marks it done.
+     */
+    struct JobResults {
+        MetricsBlock metrics;
+        ParticleJob job;
+        std::filesystem::path checkpoint; ///< removed once committed (empty for none)
+    };
+    typedef std::variant<JobResults, ParticleJob> Update;
+
+    void enqueue(Update update, size_t bytes);
+    void run();
+    bool commit(const std::vector<Update>& group, size_t n_metrics);
+    static void remove_checkpoints(const std::vector<Update>& group);
+
+    DatabaseConnection* connection;
+    size_t group_size;                                  ///< simulations whose metrics are committed together
+    std::chrono::duration<double> group_interval;       ///< longest an update waits for its group
+    size_t max_bytes;                                   ///< memory budget of the updates not yet committed
+    bool verbose;
+
+    std::deque<Update> queue;                           // oldest first
+    std::deque<size_t> queue_bytes;                     // [update] bytes
+    std::chrono::steady_clock::time_point oldest_time;  ///< when the oldest queued update was queued
+    size_t n_queued_metrics;                            ///< JobResults in #queue
+    size_t pending_bytes;                               ///< bytes queued or being committed
+    size_t n_waiting;                                   ///< simulations waiting for budget
+    size_t n_flushing;                                  ///< threads waiting for everything to be committed
+    size_t n_failed_groups;                             ///< groups given up on
+    bool stopping;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_ready;                 ///< signals the writer thread
+    std::condition_variable space_ready;                ///< signals simulations (and flushes) waiting for a commit
+    std::thread thread;
+
+    static constexpr size_t N_TRANSACTION_ATTEMPTS = 10;
+};
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**
+ * @file eligible_agents.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the EligibleAgents class that tracks which agents of a
+ *        Community can currently be infected.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+
+#include "utility.hpp"
+
+namespace checkpoint { class Writer; class Reader; }
+
+/**
+ * @brief Set of the agents in [first, last) that can currently be infected.
+ *
+ * Eligible agents are kept densely packed so that exposure sampling only has to
+ * look at them, and are removed in O(1) by swapping with the last one. Agents in
+ * a refractory period are parked in a timing wheel with one slot per day, and are
+ * re-admitted when release() reaches the day their refractory period ends.
+ * Agents that can never be infected again are simply removed.
+ */
+class EligibleAgents {
+  public:
+    EligibleAgents(size_t first, size_t last, size_t max_delay,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~EligibleAgents() = default;
+
+    void reset(size_t first, size_t last, size_t max_delay);
+
+    const std::pmr::vector<size_t>& get_agents() const { return agents; }
+    size_t size() const { return agents.size(); }
+    bool contains(size_t agent) const { return position[agent - first] != NOT_ELIGIBLE; }
+
+    void remove(size_t agent);
+    void park(size_t agent, size_t release_time);
+    void release(size_t time);
+
+    void save_state(checkpoint::Writer& out) const;
+    void load_state(checkpoint::Reader& in);
+
+  private:
+    void insert(size_t agent);
+
+    static constexpr size_t NOT_ELIGIBLE = static_cast<size_t>(-1);
+
+    size_t first;
+    std::pmr::vector<size_t> agents;   // eligible agents, in no particular order
+    std::pmr::vector<size_t> position; // [agent - first] index into agents
+    pmr_vector2d<size_t> wheel;        // [release time % wheel size] parked agents
+};
\ No newline at end of file
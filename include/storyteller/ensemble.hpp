@@ -0,0 +1,94 @@
+/**
+ * @file ensemble.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Ensemble object that advances several realizations of the
+ *        same particle together in lockstep.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "community.hpp"
+
+class Parameters;
+class Simulator;
+class DatabaseHandler;
+class RngHandler;
+class SimulationArena;
+class PopulationCache;
+class SynthpopFile;
+
+/**
+ * @brief Runs realizations of one parameter set (ie, that only differ by seed)
+ *        together, one simulated day at a time.
+ *
+ * The realizations share the Parameters and everything derived from them (eg,
+ * strain probabilities, Kinetics), while each one keeps its own Simulator, and
+ * therefore its own Community, random number streams, and Ledger. Every day the
+ * exposures of all of the realizations are evaluated by the transmission kernel
+ * as a single batch, so the kernel's vector lanes stay full even when each
+ * realization only has a handful of exposures.
+ *
+ * Each realization makes exactly the same draws and decisions as it would if it
+ * were simulated on its own, and reports its metrics under its own serial.
+ */
+class Ensemble {
+  public:
+    /**
+     * @brief A single realization of the ensemble's particle.
+     */
+    struct Realization {
+        size_t serial;
+        const RngHandler* rng_handler; ///< seeded with the realization's seed
+        DatabaseHandler* db_handler;   ///< has started the realization's job (null in the hpc mode)
+    };
+
+    Ensemble(const Parameters* parameters, const std::vector<Realization>& realizations,
+             SimulationArena* arena = nullptr);
+    ~Ensemble();
+
+    void set_flags(std::map<std::string, bool> flags);
+    void set_population_cache(PopulationCache* cache);
+    void set_synthpop(const SynthpopFile* file);
+    void set_checkpoint_interval(size_t days);
+
+    /**
+     * @brief Prepare the Ensemble for the next realizations of a batch.
+     *
+     * The Parameters and RngHandlers the Ensemble was created with must already
+     * hold the next particle's values and seeds. Only the first serials.size()
+     * realizations (at most the number the Ensemble was created with) are
+     * simulated until the next reset, and each one reuses its Simulator's
+     * storage. Must be followed by init().
+     *
+     * @param serials Serials that the realizations report under
+     */
+    void reset(const std::vector<size_t>& serials);
+
+    void init();
+    bool resume();
+    void simulate();
+    void results();
+
+    bool was_interrupted() const;
+
+    size_t size() const;
+
+  private:
+    void tick();
+    void save_checkpoints();
+
+    size_t sim_time;
+    size_t checkpoint_interval;                         // days between checkpoints (0 for none)
+    bool interrupted;                                   // stopped early on SIGTERM
+    size_t n_active;                                    // realizations simulated (see reset)
+    std::vector<std::unique_ptr<Simulator>> simulators; // [realization]
+    std::vector<size_t> offsets;                        // [realization] first exposure in the batch
+    Community::ExposureBatch batch;                     // every realization's exposures, reused every day
+    const Parameters* par;
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * @file kinetics.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Kinetics class that precomputes the waning of infection-
+ *        acquired immunity and vaccine protection for a single simulation.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <array>
+
+#include "utility.hpp"
+#include "parameters.hpp"
+
+/**
+ * @brief How infection-acquired immunity to a strain behaves, which is fixed for
+ *        a simulation.
+ */
+enum ImmunityMode {
+    NO_IMMUNITY,        // infection does not change susceptibility
+    PERMANENT_IMMUNITY, // infection leaves the agent perfectly protected
+    WANING_IMMUNITY,    // protection wanes after the refractory period
+    NUM_IMMUNITY_MODES
+};
+
+/**
+ * @brief Per-strain lookup tables of immunity and vaccine protection waning.
+ *
+ * Half-lives, lags, and refractory period lengths are fixed for a simulation and
+ * time advances in whole days, so the waning multipliers only depend on the number
+ * of days since an agent's last infection or vaccination. The tables are indexed
+ * by that number of days and reproduce the closed-form waning expressions exactly
+ * when lags and refractory periods are whole days. A strain whose lag or
+ * refractory period is fractional evaluates the closed form instead (its
+ * rounding depends on the day of the event), so the multipliers are always
+ * bit-identical to the closed forms.
+ */
+class Kinetics {
+  public:
+    Kinetics(const Parameters* parameters);
+    ~Kinetics();
+
+    bool infection_generates_immunity(StrainType strain) const;
+    bool infection_immunity_wanes(StrainType strain) const;
+    ImmunityMode immunity_mode(StrainType strain) const;
+    double refractory_period(StrainType strain) const;
+    bool vaccine_effect_wanes(StrainType strain) const;
+
+    /**
+     * @brief Fraction of baseline susceptibility regained after a waning
+     *        infection-acquired immunity.
+     *
+     * @param strain Strain of the agent's most recent infection with that strain
+     * @param time Current day
+     * @param infection_time Day of that infection
+     * @return double Multiplier applied to the agent's baseline susceptibility
+     */
+    double immunity_multiplier(StrainType strain, size_t time, size_t infection_time) const {
+        if (immunity_tabulated[strain]) { return immunity_table[strain][time - infection_time]; }
+        return closed_form_immunity(strain, time, infection_time);
+    }
+
+    /**
+     * @brief Fraction of the initial vaccine protection that remains.
+     *
+     * @param strain Strain the protection applies to
+     * @param time Current day (not before the vaccination)
+     * @param vaccination_time Day the agent was vaccinated
+     * @return double Multiplier applied to the agent's initial vaccine protection
+     */
+    double vaccine_multiplier(StrainType strain, size_t time, size_t vaccination_time) const {
+        if (vaccine_tabulated[strain]) { return vaccine_table[strain][time - vaccination_time]; }
+        return closed_form_vaccine(strain, time, vaccination_time);
+    }
+
+  private:
+    double closed_form_immunity(StrainType strain, size_t time, size_t infection_time) const;
+    double closed_form_vaccine(StrainType strain, size_t time, size_t vaccination_time) const;
+
+    std::array<bool, NUM_STRAIN_TYPES>   gen_immunity;
+    std::array<bool, NUM_STRAIN_TYPES>   immunity_wanes;
+    std::array<double, NUM_STRAIN_TYPES> refractory_len;
+    std::array<bool, NUM_STRAIN_TYPES>   vax_effect_wanes;
+    std::array<double, NUM_STRAIN_TYPES> immunity_waning_rate;
+    std::array<double, NUM_STRAIN_TYPES> vax_waning_rate;
+    std::array<double, NUM_STRAIN_TYPES> vax_waning_lag;
+    std::array<bool, NUM_STRAIN_TYPES>   immunity_tabulated; // refractory period is whole days
+    std::array<bool, NUM_STRAIN_TYPES>   vaccine_tabulated;  // waning lag is whole days
+
+    vector2d<double> immunity_table; // [strain][days since infection]
+    vector2d<double> vaccine_table;  // [strain][days since vaccination]
+};
\ No newline at end of file
@@ -9,12 +9,37 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <string>
+#include <memory_resource>
 
 #include "utility.hpp"
 #include "parameters.hpp"
+#include "person.hpp"
 
-class Infection;
+namespace checkpoint { class Writer; class Reader; }
+
+/**
+ * @brief Incidence counts for a single day collected by one chunk of a parallel
+ *        transmission step.
+ *
+ * Each chunk writes only to its own tally, and the tallies are merged into the
+ * Ledger in chunk order once the day is finished (see Ledger::merge).
+ */
+class LedgerTally {
+  friend class Ledger;
+  public:
+    void log_infection(const Infection& i, bool record);
+    void clear();
+
+  private:
+    typedef std::array<std::array<size_t, NUM_STRAIN_TYPES>, NUM_VACCINATION_STATUSES> Counts;
+
+    Counts infs        = {};  // [vax status][strain]
+    Counts sympt_infs  = {};  // [vax status][strain]
+    Counts mais        = {};  // [vax status][strain]
+    std::vector<Infection> infections;
+};
 
 /**
  * @brief Keeps track of necessary simulation data while the simulation runs and
@@ -23,26 +48,35 @@ class Infection;
 class Ledger {
   friend class Community;
   public:
-    Ledger(const Parameters* parameters);
+    Ledger(const Parameters* parameters, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~Ledger();
 
-    vector3d<size_t> get_inf_incidence() const;
-    vector3d<size_t> get_sympt_inf_incidence() const;
-    vector3d<size_t> get_mai_incidence() const;
+    const pmr_vector3d<size_t>& get_inf_incidence() const;
+    const pmr_vector3d<size_t>& get_sympt_inf_incidence() const;
+    const pmr_vector3d<size_t>& get_mai_incidence() const;
 
-    vector3d<size_t> get_cumul_infs() const;
-    vector3d<size_t> get_cumul_sympt_infs() const;
-    vector3d<size_t> get_cumul_mais() const;
+    const pmr_vector3d<size_t>& get_cumul_infs() const;
+    const pmr_vector3d<size_t>& get_cumul_sympt_infs() const;
+    const pmr_vector3d<size_t>& get_cumul_mais() const;
 
-    std::vector<size_t> get_vax_incidence() const;
-    std::vector<double> get_tnd_ve_est() const;
+    const std::pmr::vector<size_t>& get_vax_incidence() const;
+    const std::pmr::vector<double>& get_tnd_ve_est() const;
 
     size_t get_cumul_infs(VaccinationStatus vaxd, StrainType strain, size_t time) const;
     size_t get_cumul_sympt_infs(VaccinationStatus vaxd, StrainType strain, size_t time) const;
     size_t get_cumul_mais(VaccinationStatus vaxd, StrainType strain, size_t time) const;
     double get_tnd_ve_est(size_t time) const;
 
-    void log_infection(const Infection* i);
+    void set_parameters(const Parameters* parameters);
+
+    void reset();
+
+    void log_infection(const Infection& i);
+    void merge(LedgerTally& tally, size_t time);
+    void set_record_infections(bool record);
+    bool is_recording_infections() const;
+
+    std::vector<const Infection*> get_infection_history(const Person& p) const;
 
     size_t total_infections(VaccinationStatus vaxd, StrainType strain) const;
     size_t total_sympt_infections(VaccinationStatus vaxd, StrainType strain) const;
@@ -55,21 +89,25 @@ class Ledger {
     void generate_linelist_csv(std::string filepath = "");
     void generate_simvis_csv(std::string filepath = "");
 
+    void save_state(checkpoint::Writer& out) const;
+    void load_state(checkpoint::Reader& in, Population* population);
+
   private:
     // EPIDEMIC DATA
-    std::vector<const Infection*> infections;
-    vector3d<size_t> inf_incidence;       // [vax status][strain][time]
-    vector3d<size_t> sympt_inf_incidence; // [vax status][strain][time]
-    vector3d<size_t> mai_incidence;       // [vax status][strain][time]
+    bool record_infections;                 // keep every Infection for the linelist
+    std::pmr::vector<Infection> infections; // only populated if record_infections
+    pmr_vector3d<size_t> inf_incidence;       // [vax status][strain][time]
+    pmr_vector3d<size_t> sympt_inf_incidence; // [vax status][strain][time]
+    pmr_vector3d<size_t> mai_incidence;       // [vax status][strain][time]
 
-    vector3d<size_t> cumul_infs;       // [vax status][strain][time]
-    vector3d<size_t> cumul_sympt_infs; // [vax status][strain][time]
-    vector3d<size_t> cumul_mais;       // [vax status][strain][time]
+    pmr_vector3d<size_t> cumul_infs;       // [vax status][strain][time]
+    pmr_vector3d<size_t> cumul_sympt_infs; // [vax status][strain][time]
+    pmr_vector3d<size_t> cumul_mais;       // [vax status][strain][time]
 
-    std::vector<double> tnd_ve_estimate; // [time]
+    std::pmr::vector<double> tnd_ve_estimate; // [time]
 
     // POPULATION DATA
-    std::vector<size_t> vax_incidence; // [time]
+    std::pmr::vector<size_t> vax_incidence; // [time]
 
     std::string linelist_header;
     std::string simvis_header;
@@ -0,0 +1,188 @@
+/**
+ * @file parameter_set.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the compiled parameter schema that assigns every parameter a
+ *        dense slot and the flat ParameterSet that stores values by slot.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Handles for the parameters that the simulation engine reads directly.
+ *
+ * The ParameterSchema reserves these slots first and in this order, so a
+ * ParameterId is also the slot of that parameter in every ParameterSet.
+ */
+enum ParameterId : size_t {
+    SEED,
+    SIM_DURATION,
+    POP_SIZE,
+    PR_VAX,
+    PR_PRIOR_IMM_VAXD,
+    PR_PRIOR_IMM_UNVAXD,
+    VAXD_FLU_SUSCEP_IS_CONTIN,
+    VAXD_FLU_SUSCEP_MEAN,
+    VAXD_FLU_SUSCEP_SD,
+    VAXD_FLU_SUSCEP_BASELINE,
+    UNVAXD_FLU_SUSCEP_IS_CONTIN,
+    UNVAXD_FLU_SUSCEP_MEAN,
+    UNVAXD_FLU_SUSCEP_SD,
+    UNVAXD_FLU_SUSCEP_BASELINE,
+    VAXD_NONFLU_SUSCEP_IS_CONTIN,
+    VAXD_NONFLU_SUSCEP_MEAN,
+    VAXD_NONFLU_SUSCEP_SD,
+    VAXD_NONFLU_SUSCEP_BASELINE,
+    UNVAXD_NONFLU_SUSCEP_IS_CONTIN,
+    UNVAXD_NONFLU_SUSCEP_MEAN,
+    UNVAXD_NONFLU_SUSCEP_SD,
+    UNVAXD_NONFLU_SUSCEP_BASELINE,
+    FLU_INF_REFRACT_LEN,
+    FLU_INF_GEN_IMMUNITY,
+    FLU_INF_IMMUNITY_WANES,
+    FLU_INF_IMMUNITY_HALF_LIFE,
+    NONFLU_INF_REFRACT_LEN,
+    NONFLU_INF_GEN_IMMUNITY,
+    NONFLU_INF_IMMUNITY_WANES,
+    NONFLU_INF_IMMUNITY_HALF_LIFE,
+    FLU_VAX_EFFECT_IS_CONTIN,
+    FLU_VAX_EFFECT_MEAN,
+    FLU_VAX_EFFECT_VAR,
+    FLU_VAX_EFFECT_WANES,
+    FLU_VAX_EFFECT_HALF_LIFE,
+    FLU_VAX_EFFECT_LAG_TIL_WANING,
+    NONFLU_VAX_EFFECT_IS_CONTIN,
+    NONFLU_VAX_EFFECT_MEAN,
+    NONFLU_VAX_EFFECT_VAR,
+    NONFLU_VAX_EFFECT_WANES,
+    NONFLU_VAX_EFFECT_HALF_LIFE,
+    NONFLU_VAX_EFFECT_LAG_TIL_WANING,
+    PR_SYMPT_FLU,
+    PR_SYMPT_NONFLU,
+    PR_CARESEEKING_VAXD,
+    PR_CARESEEKING_UNVAXD,
+    PR_FLU_EXPOSURE,
+    PR_NONFLU_EXPOSURE,
+    SEASONAL_AMPLITUDE_MULT,
+    SEASONAL_PERIOD,
+    SEASONAL_SHIFT,
+    NUM_BUILTIN_PARAMETERS
+};
+
+/**
+ * @brief Nicknames (ie, experiment database column names) of the built-in
+ *        parameters, indexed by ParameterId.
+ */
+inline constexpr std::array<const char*, NUM_BUILTIN_PARAMETERS> builtin_parameter_nicknames = {
+    "seed",
+    "sim_duration",
+    "pop_size",
+    "pr_vax",
+    "pr_prior_imm_vaxd",
+    "pr_prior_imm_unvaxd",
+    "vaxd_flu_suscep_is_contin",
+    "vaxd_flu_suscep_mean",
+    "vaxd_flu_suscep_sd",
+    "vaxd_flu_suscep_baseline",
+    "unvaxd_flu_suscep_is_contin",
+    "unvaxd_flu_suscep_mean",
+    "unvaxd_flu_suscep_sd",
+    "unvaxd_flu_suscep_baseline",
+    "vaxd_nonflu_suscep_is_contin",
+    "vaxd_nonflu_suscep_mean",
+    "vaxd_nonflu_suscep_sd",
+    "vaxd_nonflu_suscep_baseline",
+    "unvaxd_nonflu_suscep_is_contin",
+    "unvaxd_nonflu_suscep_mean",
+    "unvaxd_nonflu_suscep_sd",
+    "unvaxd_nonflu_suscep_baseline",
+    "flu_inf_refract_len",
+    "flu_inf_gen_immunity",
+    "flu_inf_immunity_wanes",
+    "flu_inf_immunity_half_life",
+    "nonflu_inf_refract_len",
+    "nonflu_inf_gen_immunity",
+    "nonflu_inf_immunity_wanes",
+    "nonflu_inf_immunity_half_life",
+    "flu_vax_effect_is_contin",
+    "flu_vax_effect_mean",
+    "flu_vax_effect_var",
+    "flu_vax_effect_wanes",
+    "flu_vax_effect_half_life",
+    "flu_vax_effect_lag_til_waning",
+    "nonflu_vax_effect_is_contin",
+    "nonflu_vax_effect_mean",
+    "nonflu_vax_effect_var",
+    "nonflu_vax_effect_wanes",
+    "nonflu_vax_effect_half_life",
+    "nonflu_vax_effect_lag_til_waning",
+    "pr_sympt_flu",
+    "pr_sympt_nonflu",
+    "pr_careseeking_vaxd",
+    "pr_careseeking_unvaxd",
+    "pr_flu_exposure",
+    "pr_nonflu_exposure",
+    "seasonal_amplitude_mult",
+    "seasonal_period",
+    "seasonal_shift"
+};
+
+/**
+ * @brief Compiled description of every parameter in an experiment.
+ *
+ * Built once when the Tome is loaded. Each parameter is assigned a dense integer
+ * slot that is used to index the values of a ParameterSet, so that parameter
+ * access during a simulation never touches a string.
+ */
+class ParameterSchema {
+  public:
+    ParameterSchema();
+    ~ParameterSchema() = default;
+
+    size_t declare(const std::string& fullname, const std::string& nickname,
+                   const std::string& datatype, const std::string& flag);
+
+    size_t size() const;
+    bool has(const std::string& name) const;
+    size_t slot_of(const std::string& name) const;
+    bool is_declared(size_t slot) const;
+
+    const std::string& get_fullname(size_t slot) const;
+    const std::string& get_nickname(size_t slot) const;
+    const std::string& get_datatype(size_t slot) const;
+    const std::string& get_flag(size_t slot) const;
+
+  private:
+    std::vector<std::string> fullnames;
+    std::vector<std::string> nicknames;
+    std::vector<std::string> datatypes;
+    std::vector<std::string> flags;
+    std::vector<bool> declared;
+
+    std::map<std::string, size_t> slots; // fullname/nickname -> slot
+};
+
+/**
+ * @brief Flat set of parameter values indexed by ParameterSchema slot.
+ */
+class ParameterSet {
+  public:
+    ParameterSet();
+    ParameterSet(const ParameterSchema* schema);
+    ~ParameterSet() = default;
+
+    double& operator[](size_t slot) { return values[slot]; }
+    double operator[](size_t slot) const { return values[slot]; }
+
+    size_t size() const;
+    const ParameterSchema* get_schema() const;
+
+  private:
+    const ParameterSchema* schema;
+    std::vector<double> values;
+};
\ No newline at end of file
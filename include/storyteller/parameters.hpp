@@ -10,17 +10,22 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
 
-#include <sol/sol.hpp>
+#include <gsl/gsl_rng.h>
+
+#include "parameter_set.hpp"
 
 class Person;
 class RngHandler;
 class DatabaseHandler;
 class Tome;
+class Kinetics;
 
 enum StrainType {
     NON_INFLUENZA,
@@ -56,26 +61,12 @@ enum GammaDistributionParameter {
 
 typedef std::array<double, NUM_GAMMA_DISTR_PARAMS> GammaDistrParamArray;
 
-class Parameter {
-  friend class Parameters;
-  public:
-    Parameter(const std::string name, const sol::table& attributes);
-    ~Parameter();
-
-    std::string get_fullname() const;
-    std::string get_nickname() const;
-    double      get_value()    const;
-
-    bool validate() const;
-
-  private:
-    std::string    fullname;
-    std::string    nickname;
-    std::string    description;
-    std::string    flag;
-    std::string    datatype;
-    double         value;
-    sol::protected_function _validate;
+/**
+ * @brief A single agent's exposure to a strain on a given day.
+ */
+struct Exposure {
+    size_t agent;      ///< index of the exposed agent in the Population
+    StrainType strain; ///< strain the agent was exposed to
 };
 
 /**
@@ -84,25 +75,44 @@ class Parameter {
  * A Parameters object can either be default constructed and use pre-defined
  * parameter values or can be initialized using parameter values read by the
  * Storyteller from the experiment database.
+ *
+ * Constructing and reading a Parameters object never calls into Lua: parameter
+ * values are validated once when the experiment database is initialized (see
+ * DatabaseHandler::init_database), so particles can be set up on any thread.
  */
 class Parameters {
   public:
     Parameters(RngHandler* rngh, DatabaseHandler* dbh, const Tome* t);
-    ~Parameters() = default;
+    ~Parameters();
 
     void read_parameters_for_serial(size_t serial);
-    void read_parameters_from_batch(size_t serial, std::map<std::string, double> pars_from_db);
+    void read_parameters_from_batch(size_t serial, const ParameterSet& pars_from_db);
+    void read_default_parameters(const std::map<std::string, double>& overrides = {});
 
-    bool insert(const std::string key, const sol::table& attributes);
-    double get(std::string key) const;
+    /**
+     * @brief Get the value of a built-in parameter through its interned slot.
+     */
+    double get(ParameterId id) const { return values[id]; }
 
-    std::vector<double> sample_susceptibility(const Person* p) const;
-    std::vector<double> sample_vaccine_effect() const;
+    /**
+     * @brief Get the value of any parameter by its full name or nickname.
+     */
+    double get(const std::string& key) const;
+
+    const ParameterSet& get_values() const;
+
+    void sample_susceptibility(VaccinationStatus vaxd, StrainType strain, gsl_rng* stream, double* out, size_t n) const;
+    void sample_vaccine_effect(StrainType strain, gsl_rng* stream, double* out, size_t n) const;
+    void susceptibility_from_uniform(VaccinationStatus vaxd, StrainType strain, const double* u, double* out, size_t n) const;
+    void vaccine_effect_from_uniform(StrainType strain, const double* u, double* out, size_t n) const;
     StrainType sample_strain(const size_t time) const;
-    std::vector<StrainType> daily_strain_sample(const size_t time) const;
+    void sample_daily_exposures(const size_t time, const std::pmr::vector<size_t>& candidates, gsl_rng* stream,
+                                std::pmr::vector<Exposure>& exposures, std::pmr::vector<uint8_t>& chosen) const;
 
     bool are_valid() const;
 
+    const Kinetics* get_kinetics() const;
+
     // void update_time_varying_parameters();
 
     std::vector<std::vector<double>> strain_probs; //[time][strain]
@@ -117,19 +127,20 @@ class Parameters {
     const Tome* tome;
 
   private:
-    std::map<std::string, std::unique_ptr<Parameter>> params;
-    std::map<std::string, std::string> lookup;
+    const ParameterSchema* schema;
+    ParameterSet values;
 
-    std::vector<std::string> pars_to_read;
+    std::unique_ptr<Kinetics> kinetics;
 
     void calc_strain_probs();
-    void slurp_params(std::map<std::string, double> pars_from_db);
+    void calc_kinetics();
+    void slurp_params(const ParameterSet& pars_from_db);
 
-    double sample_discrete_susceptibility(const bool vaccinated, const StrainType strain) const;
-    double sample_continuous_susceptibility(const bool vaccinated, const StrainType strain) const;
+    void sample_discrete_susceptibility(const bool vaccinated, const StrainType strain, gsl_rng* stream, double* out, size_t n) const;
+    void sample_continuous_susceptibility(const bool vaccinated, const StrainType strain, gsl_rng* stream, double* out, size_t n) const;
 
-    double sample_discrete_vaccine_effect(const StrainType strain) const;
-    double sample_continuous_vaccine_effect(const StrainType strain) const;
+    void sample_discrete_vaccine_effect(const StrainType strain, gsl_rng* stream, double* out, size_t n) const;
+    void sample_continuous_vaccine_effect(const StrainType strain, gsl_rng* stream, double* out, size_t n) const;
 
     RngHandler* rng;
     DatabaseHandler* db;
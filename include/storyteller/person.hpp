@@ -11,40 +11,33 @@
 
 #include <vector>
 #include <memory>
+#include <optional>
 #include <iostream>
 
 #include "parameters.hpp"
 
+class Population;
+class Infection;
+
 /**
- * @brief Represents a single infection event for a Person and stores all relevant
- *        infection information.
+ * @brief Uniform draws consumed by a single infection attempt, which are drawn in
+ *        bulk for all of a day's exposures.
  */
-class Infection {
-  friend class Person;
-  public:
-    Infection(Person* p, StrainType strain, size_t time, SymptomClass sympt, bool care);
-    ~Infection();
-
-    Person* get_infectee() const;
-    StrainType get_strain() const;
-    size_t get_infection_time() const;
-    SymptomClass get_symptoms() const;
-    bool get_sought_care() const;
-
-  private:
-    Person* infectee;
-    StrainType infection_strain;
-    size_t infection_time;
-    SymptomClass symptoms;
-    bool sought_care;
+struct InfectionDraws {
+    double infection;
+    double symptoms;
+    double care_seeking;
 };
 
 /**
  * @brief Primary agent of the simulation that is stored in a Community.
+ *
+ * A Person is a lightweight view into the Population that owns the agent's
+ * state, so it is cheap to construct and copy.
  */
 class Person {
   public:
-    Person(size_t id, const Parameters* parameters, const RngHandler* rng_handler);
+    Person(Population* population, size_t idx);
     ~Person();
 
     size_t get_id() const;
@@ -57,32 +50,52 @@ class Person {
     double get_remaining_vaccine_protection(StrainType strain, size_t time) const;
     void set_vaccine_protection(StrainType strain, double vp);
 
-    const std::vector<std::unique_ptr<Infection>>& get_infection_history() const;
-
-    Infection* attempt_infection(StrainType strain, size_t time);
+    std::optional<Infection> attempt_infection(StrainType strain, size_t time, const InfectionDraws& u);
+    Infection infect(StrainType strain, size_t time, SymptomClass sympt, bool seek_care);
     bool vaccinate(size_t time);
 
     bool has_been_infected() const;
     bool has_been_infected_with(StrainType strain) const;
     bool is_vaccinated() const;
     bool is_susceptible_to(StrainType strain, size_t time) const;
+    bool is_permanently_immune_to(StrainType strain) const;
 
-    Infection* most_recent_infection() const;
-    Infection* most_recent_infection(StrainType strain) const;
     size_t last_infection_time() const;
+    size_t last_infection_time(StrainType strain) const;
     size_t last_infection_strain() const;
+    size_t infection_count(StrainType strain) const;
 
     friend std::ostream& operator<<(std::ostream& o , const Person& p);
 
   private:
     void update_susceptibility();
 
-    size_t id;
-    std::vector<double> susceptibility;
-    std::vector<double> vaccine_protection;
-    std::vector<std::unique_ptr<Infection>> infection_history;
-    VaccinationStatus vaccination_status;
-    size_t vaccination_time;
-    const Parameters* par;
-    const RngHandler* rng;
+    Population* pop;
+    size_t idx;
+};
+
+/**
+ * @brief Represents a single infection event for a Person and stores all relevant
+ *        infection information.
+ *
+ * Infections are not retained by the Population; the Ledger keeps them only when
+ * a linelist is requested.
+ */
+class Infection {
+  public:
+    Infection(Person p, StrainType strain, size_t time, SymptomClass sympt, bool care);
+    ~Infection();
+
+    Person get_infectee() const;
+    StrainType get_strain() const;
+    size_t get_infection_time() const;
+    SymptomClass get_symptoms() const;
+    bool get_sought_care() const;
+
+  private:
+    Person infectee;
+    StrainType infection_strain;
+    size_t infection_time;
+    SymptomClass symptoms;
+    bool sought_care;
 };
\ No newline at end of file
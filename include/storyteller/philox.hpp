@@ -0,0 +1,55 @@
+/**
+ * @file philox.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Philox4x32-10 counter-based generator and its GSL rng type.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <gsl/gsl_rng.h>
+
+/**
+ * @brief Philox4x32-10 counter-based pseudo-random number generator.
+ *
+ * Each output block is a pure function of a 128-bit counter and a 64-bit key
+ * (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11), so blocks
+ * can be generated many at a time and independent streams are just different keys.
+ */
+namespace philox {
+    typedef std::array<uint32_t, 4> Counter;
+    typedef std::array<uint32_t, 2> Key;
+
+    /**
+     * @brief State of a Philox stream used through the gsl_rng interface.
+     */
+    struct State {
+        Key key;
+        Counter counter;  // counter of the next block to generate
+        Counter buffer;   // most recently generated block
+        size_t next;      // index of the next unused value in buffer (4 = empty)
+    };
+
+    /**
+     * @brief Compute the 10-round Philox4x32 block for a counter and key.
+     */
+    Counter block(Counter counter, Key key);
+
+    /**
+     * @brief Fill out with n uniform doubles in [0, 1) from the stream.
+     *
+     * Gives exactly the values that n calls to gsl_rng_uniform would, but
+     * generates whole blocks in batches.
+     */
+    void fill_uniform(State* state, double* out, size_t n);
+}
+
+/**
+ * @brief GSL rng type that wraps philox::State, so Philox streams can be used
+ *        anywhere a gsl_rng is (eg, gsl_ran_* distributions).
+ */
+extern const gsl_rng_type* gsl_rng_philox4x32;
\ No newline at end of file
@@ -0,0 +1,111 @@
+/**
+ * @file population.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Population class that stores the state of every agent in
+ *        a synthetic population using contiguous per-field arrays.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory_resource>
+
+#include "utility.hpp"
+#include "parameters.hpp"
+#include "person.hpp"
+#include "kinetics.hpp"
+
+class RngHandler;
+class ThreadPool;
+struct PopulationSnapshot;
+namespace checkpoint { class Writer; class Reader; }
+
+/**
+ * @brief Structure-of-arrays store for all agent state in a Community.
+ *
+ * Each agent attribute is kept in its own contiguous array indexed by the agent
+ * index so that population-wide passes (eg, transmission) stream linearly through
+ * memory. Individual agents are accessed through lightweight Person views.
+ */
+class Population {
+  friend class Person;
+  friend class SynthpopFile;
+  public:
+    Population(const Parameters* parameters, const RngHandler* rng_handler,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~Population();
+
+    size_t size() const;
+
+    Person operator[](size_t idx);
+
+    void reset();
+
+    void set_parameters(const Parameters* parameters);
+
+    size_t synthesize(size_t time, ThreadPool* pool = nullptr);
+
+    static std::vector<double> synthesis_key(const ParameterSet& pars);
+    static std::vector<double> synthesis_key(const ParameterSet& pars, unsigned long int seed);
+    void save(PopulationSnapshot& snapshot) const;
+    void restore(const PopulationSnapshot& snapshot);
+
+    void save_state(checkpoint::Writer& out) const;
+    void load_state(checkpoint::Reader& in);
+
+    void specialize_transmission();
+    void gather_exposed(const std::pmr::vector<Exposure>& exposed, size_t time, double* susceptibility_out,
+                        double* vaccine_protection_out, double* pr_careseeking_out) const;
+
+    /**
+     * @brief Number of agents synthesized from each random number stream.
+     *
+     * Fixed (rather than derived from the thread count) so that the synthetic
+     * population is the same for any number of threads.
+     */
+    static constexpr size_t SYNTHESIS_BLOCK_SIZE = 1 << 16;
+
+    /**
+     * @brief Every parameter that synthesize() depends on (the seed selects its
+     *        streams, and the simulation duration is the "never" time of the
+     *        unvaccinated).
+     */
+    static constexpr std::array<ParameterId, 28> SYNTHESIS_PARAMETERS = {
+        SEED, SIM_DURATION, POP_SIZE, PR_VAX, PR_PRIOR_IMM_VAXD, PR_PRIOR_IMM_UNVAXD,
+        VAXD_FLU_SUSCEP_IS_CONTIN, VAXD_FLU_SUSCEP_MEAN, VAXD_FLU_SUSCEP_SD, VAXD_FLU_SUSCEP_BASELINE,
+        UNVAXD_FLU_SUSCEP_IS_CONTIN, UNVAXD_FLU_SUSCEP_MEAN, UNVAXD_FLU_SUSCEP_SD, UNVAXD_FLU_SUSCEP_BASELINE,
+        VAXD_NONFLU_SUSCEP_IS_CONTIN, VAXD_NONFLU_SUSCEP_MEAN, VAXD_NONFLU_SUSCEP_SD, VAXD_NONFLU_SUSCEP_BASELINE,
+        UNVAXD_NONFLU_SUSCEP_IS_CONTIN, UNVAXD_NONFLU_SUSCEP_MEAN, UNVAXD_NONFLU_SUSCEP_SD, UNVAXD_NONFLU_SUSCEP_BASELINE,
+        FLU_VAX_EFFECT_IS_CONTIN, FLU_VAX_EFFECT_MEAN, FLU_VAX_EFFECT_VAR,
+        NONFLU_VAX_EFFECT_IS_CONTIN, NONFLU_VAX_EFFECT_MEAN, NONFLU_VAX_EFFECT_VAR
+    };
+
+  private:
+    size_t synthesize_block(size_t time, size_t block, size_t first, size_t last);
+    size_t synthesize_keyed_block(size_t time, size_t first, size_t last);
+
+    template<ImmunityMode IMMUNITY, bool VAX_WANES>
+    void gather_exposed_to(const std::pmr::vector<Exposure>& exposed, StrainType strain, size_t time,
+                           double* susceptibility_out, double* vaccine_protection_out,
+                           double* pr_careseeking_out) const;
+
+    using ExposedGatherer = void (Population::*)(const std::pmr::vector<Exposure>&, StrainType, size_t,
+                                                 double*, double*, double*) const;
+
+    std::pmr::vector<size_t>            id;                    // [person]
+    std::pmr::vector<VaccinationStatus> vaccination_status;    // [person]
+    std::pmr::vector<size_t>            vaccination_time;      // [person]
+    pmr_vector2d<double>                susceptibility;        // [strain][person]
+    pmr_vector2d<double>                vaccine_protection;    // [strain][person]
+    std::pmr::vector<size_t>            last_infection_time;   // [person]
+    std::pmr::vector<StrainType>        last_infection_strain; // [person]
+    pmr_vector2d<size_t>                strain_infection_time; // [strain][person] most recent infection with strain
+    pmr_vector2d<size_t>                strain_infection_count;// [strain][person]
+
+    std::array<ExposedGatherer, NUM_STRAIN_TYPES> gatherers;   // [strain] see specialize_transmission()
+
+    const Parameters* par;
+    const RngHandler* rng;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+/**
+ * @file population_cache.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the PopulationCache that keeps synthesized populations so that
+ *        particles sharing the population parameters and seed can reuse them.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "parameters.hpp"
+
+/**
+ * @brief Copy of every agent attribute written by Population::synthesize.
+ */
+struct PopulationSnapshot {
+    std::vector<double> key;                                       ///< see Population::synthesis_key
+    size_t vaccinated;                                             ///< agents vaccinated by the synthesis
+    std::vector<VaccinationStatus> vaccination_status;             // [person]
+    std::vector<size_t> vaccination_time;                          // [person]
+    std::array<std::vector<double>, NUM_STRAIN_TYPES> susceptibility;     // [strain][person]
+    std::array<std::vector<double>, NUM_STRAIN_TYPES> vaccine_protection; // [strain][person]
+};
+
+/**
+ * @brief Keeps the most recently synthesized populations of a batch.
+ *
+ * Population synthesis draws from its own streams, so a restored snapshot is
+ * identical to a fresh synthesis and leaves every other stream untouched. The
+ * cache holds at most #capacity snapshots and evicts the oldest first; it is
+ * safe to share between the workers of a batch.
+ */
+class PopulationCache {
+  public:
+    PopulationCache(size_t max_snapshots);
+    ~PopulationCache() = default;
+
+    std::shared_ptr<const PopulationSnapshot> find(const std::vector<double>& key);
+    void insert(std::shared_ptr<const PopulationSnapshot> snapshot);
+
+    size_t get_hits() const;
+    size_t get_misses() const;
+
+  private:
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+    std::deque<std::shared_ptr<const PopulationSnapshot>> snapshots; // oldest first
+    mutable std::mutex mutex;
+};
\ No newline at end of file
@@ -8,13 +8,18 @@
  */
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <map>
+#include <optional>
+#include <filesystem>
 #include <vector>
 
 #include <gsl/gsl_rng.h>
 
+#include "parameter_set.hpp"
+
 class Parameters;
 class Community;
 class Infection;
@@ -22,6 +27,12 @@ class Ledger;
 class DatabaseHandler;
 class RngHandler;
 class Person;
+class Population;
+class SimulationArena;
+class ThreadPool;
+class PopulationCache;
+class SynthpopFile;
+namespace checkpoint { struct Header; }
 
 /**
  * @brief Main simulation object that handles simulation setup, performs the
@@ -33,6 +44,7 @@ class Person;
  * specified simulation.
  */
 class Simulator {
+  friend class Ensemble;
   public:
     /**
      * @brief Construct a new Simulator object with the Parameters, DatabaseHandler,
@@ -41,8 +53,10 @@ class Simulator {
      * @param parameters Parameters object owned by the Storyteller
      * @param dbh Database object owned by the Storyteller
      * @param rngh RngHandler object owned by the Storyteller
+     * @param arena Memory arena that all simulation storage is allocated from
+     *              (uses the default allocator if null)
      */
-    Simulator(const Parameters* parameters, DatabaseHandler* dbh, const RngHandler* rngh);
+    Simulator(const Parameters* parameters, DatabaseHandler* dbh, const RngHandler* rngh, SimulationArena* arena = nullptr);
     ~Simulator();
 
     /**
@@ -52,23 +66,116 @@ class Simulator {
      */
     void set_flags(std::map<std::string, bool> flags);
 
+    /**
+     * @brief Report results under a different serial than the Parameters' (eg,
+     *        for a realization of an Ensemble that shares its Parameters).
+     *
+     * @param simulation_serial Serial of the simulation
+     */
+    void set_serial(size_t simulation_serial);
+
+    /**
+     * @brief Run transmission in the chunked, deterministic parallel mode.
+     *
+     * @param pool ThreadPool owned by the Storyteller (null for the serial mode)
+     */
+    void set_thread_pool(ThreadPool* pool);
+
+    /**
+     * @brief Reuse the populations synthesized by earlier simulations.
+     *
+     * @param cache PopulationCache owned by the Storyteller (null to always synthesize)
+     */
+    void set_population_cache(PopulationCache* cache);
+
+    /**
+     * @brief Load the population from a binary synthetic population file instead
+     *        of synthesizing it.
+     *
+     * @param file SynthpopFile owned by the Storyteller (null to synthesize)
+     */
+    void set_synthpop(const SynthpopFile* file);
+
+    /**
+     * @brief Write a checkpoint every few simulated days (and when SIGTERM is
+     *        received, see checkpoint::install_termination_handler).
+     *
+     * @param days Days between checkpoints (0 disables periodic checkpoints)
+     */
+    void set_checkpoint_interval(size_t days);
+
     /**
      * @brief Perform the necessary tasks to initialize a simulation.
      */
     void init();
 
+    /**
+     * @brief Prepare the Simulator for the next particle of a batch.
+     *
+     * The Parameters (and RngHandler) the Simulator was created with must already
+     * hold the next particle's values. Simulation storage is reused, so the
+     * Simulator should be created for the batch's largest particle. Must be
+     * followed by init().
+     */
+    void reset();
+
+    /**
+     * @brief Restore the simulation from its latest checkpoint, if it has one.
+     *        Must be called after init().
+     *
+     * @return true The simulation will continue from the checkpointed day
+     * @return false There is no checkpoint, so the simulation starts from day 0
+     */
+    bool resume();
+
+    /**
+     * @brief Whether simulate() stopped early (after checkpointing) because SIGTERM
+     *        was received.
+     */
+    bool was_interrupted() const;
+
     /**
      * @brief Perform the simulation itself.
      */
     void simulate();
 
+    /**
+     * @brief Perform the simulation up to (but not including) a given day.
+     *
+     * @param time First day that is not simulated
+     */
+    void simulate_until(size_t time);
+
+    /**
+     * @brief Continue the simulation as a branch with different parameters,
+     *        reported under its own serial.
+     *
+     * The branch's parameters may only differ from the current ones in
+     * #BRANCH_PARAMETERS, which are read as the simulation goes and never shape
+     * the simulation's state.
+     *
+     * @param parameters Parameters of the branch
+     * @param dbh DatabaseHandler that has started the branch's job (null in the hpc mode)
+     * @param simulation_serial Serial of the branch
+     */
+    void branch(const Parameters* parameters, DatabaseHandler* dbh, size_t simulation_serial);
+
+    /**
+     * @brief Parameters that may differ between the branches of a simulation.
+     */
+    static constexpr std::array<ParameterId, 9> BRANCH_PARAMETERS = {
+        PR_SYMPT_FLU, PR_SYMPT_NONFLU, PR_CARESEEKING_VAXD, PR_CARESEEKING_UNVAXD,
+        PR_FLU_EXPOSURE, PR_NONFLU_EXPOSURE, SEASONAL_AMPLITUDE_MULT, SEASONAL_PERIOD, SEASONAL_SHIFT
+    };
+
     /**
      * @brief Perform any necessary post-simulation processing and report requested
      *        simulation metrics.
      */
     void results();
 
-    std::vector<Person*> get_population() const;
+    Population* get_population() const;
+    const Ledger* get_ledger() const;
 
   private:
     /**
@@ -79,11 +186,21 @@ class Simulator {
 
     void write_metrics_csv();
 
+    std::filesystem::path checkpoint_path() const;
+    checkpoint::Header checkpoint_header() const;
+    std::optional<size_t> checkpoint_time() const;
+    void save_checkpoint();
+
     size_t sim_time;                        ///< Current simulation time step
+    size_t serial;                          ///< Serial that results are reported under
     std::map<std::string, bool> sim_flags;  ///< Program flags provided by the Storyteller
+    size_t checkpoint_interval;             ///< Days between checkpoints (0 for none)
+    bool checkpointed;                      ///< A checkpoint was written or restored
+    bool interrupted;                       ///< Stopped early on SIGTERM
 
     std::unique_ptr<Community> community;   ///< Created for each simulation
     const RngHandler* rng_handler;          ///< Points to #Storyteller::rng_handler
     const Parameters* par;                  ///< Points to #Storyteller::parameters
     DatabaseHandler* db_handler;            ///< Points to #Storyteller::db_handler
+    SimulationArena* arena;                 ///< Points to #Storyteller::arena
 };
\ No newline at end of file
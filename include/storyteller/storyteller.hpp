@@ -12,15 +12,24 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include <argh.h>
 
+#include "parameter_set.hpp"
+
 class Simulator;
+class Ensemble;
 class DatabaseHandler;
+class DatabaseWriter;
 class ParticleJob;
 class RngHandler;
 class Parameters;
 class Tome;
+class SimulationArena;
+class ThreadPool;
+class PopulationCache;
+class SynthpopFile;
 namespace sol { class state; }
 
 /**
@@ -61,6 +70,13 @@ class Storyteller {
     const Parameters* get_parameters() const;
     const Tome* get_tome() const;
 
+    /**
+     * @brief Get the writer that commits the batch's metrics and job updates.
+     *
+     * @return DatabaseWriter* Background writer (null when simulations write directly)
+     */
+    DatabaseWriter* get_database_writer() const;
+
     /**
      * @brief Get the simulation serial.
      *
@@ -116,7 +132,8 @@ class Storyteller {
     bool sensible_inputs() const;
 
     /**
-     * @brief Initialize Storteller for running a batch of simulations.
+     * @brief Initialize Storteller for running a batch of simulations by reading
+     *        the parameters of every particle in the batch at once.
      */
     void init_batch();
 
@@ -127,6 +144,11 @@ class Storyteller {
      */
     void init_simulation(const size_t index);
 
+    /**
+     * @brief Create the simulation objects reused by every particle of a batch.
+     */
+    void init_simulation_context();
+
     /**
      * @brief Constructs a new experiment database given the user-provided
      *        configuration file.
@@ -142,6 +164,76 @@ class Storyteller {
      */
     int batch_simulation();
 
+    /**
+     * @brief Runs a batch of simulations with the realizations of each particle
+     *        advanced together by an Ensemble.
+     *
+     * @return int Return code (0 if sucessful)
+     */
+    int ensemble_simulation();
+
+    /**
+     * @brief Runs a batch of simulations with several particles simulated
+     *        concurrently by BatchWorkers.
+     *
+     * @return int Return code (0 if sucessful)
+     */
+    int parallel_batch_simulation();
+
+    /**
+     * @brief Runs a batch of simulations that branch from shared simulations of
+     *        their first #branch_day days.
+     *
+     * @return int Return code (0 if sucessful)
+     */
+    int branch_simulation();
+
+    /**
+     * @brief Waits for the #db_writer to commit the batch's remaining results.
+     *
+     * @return int Return code (0 if every result was committed)
+     */
+    int flush_database_writer();
+
+    /**
+     * @brief Groups the batch into particles that only differ in
+     *        Simulator::BRANCH_PARAMETERS.
+     *
+     * @return std::vector<std::vector<size_t>> Batch indices of each group
+     */
+    std::vector<std::vector<size_t>> group_branches() const;
+
+    /**
+     * @brief Initialize Storyteller for simulating the shared days of a group of
+     *        branches, without starting any job.
+     */
+    void init_trunk(const size_t index);
+
+    /**
+     * @brief Finishes a branch in a forked child process, which never returns.
+     */
+    [[noreturn]] void run_branch(const int serial_start, const size_t index);
+
+    /**
+     * @brief Groups the batch into ensembles of realizations of the same particle.
+     *
+     * @return std::vector<std::vector<size_t>> Batch indices of each ensemble
+     */
+    std::vector<std::vector<size_t>> group_realizations() const;
+
+    /**
+     * @brief Orders the batch so that particles which synthesize the same
+     *        population are simulated one after another.
+     *
+     * @return std::vector<size_t> Batch indices in simulation order
+     */
+    std::vector<size_t> population_order() const;
+
+    /**
+     * @brief Initialize Storyteller for running an ensemble of realizations.
+     */
+    void init_ensemble(const int serial_start, const std::vector<size_t>& indices);
+
     /**
      * @brief Calls the Rscript to generate the simulation dashboard.
      *
@@ -170,9 +262,18 @@ class Storyteller {
     std::unique_ptr<RngHandler> rng_handler;        ///< Handles all pseudo-random number generation
     std::unique_ptr<Parameters> parameters;         ///< Stores all necessary simulation parameters
     std::unique_ptr<sol::state> lua_vm;
+    std::unique_ptr<SimulationArena> arena;         ///< Retained across the simulations in a batch
+    std::unique_ptr<ThreadPool> thread_pool;        ///< Only created for the parallel transmission mode
+    std::unique_ptr<Ensemble> ensemble;             ///< Created for each ensemble to be run
+    std::unique_ptr<PopulationCache> population_cache; ///< Only created when populations are reused
+    std::unique_ptr<SynthpopFile> synthpop;         ///< Only created when the population is loaded from a file
+    std::unique_ptr<DatabaseWriter> db_writer;      ///< Only created for batches that write to the database
+
+    std::vector<std::unique_ptr<RngHandler>> ensemble_rng_handlers;     ///< [realization] of #ensemble
+    std::vector<std::unique_ptr<DatabaseHandler>> ensemble_db_handlers; ///< [realization] of #ensemble
 
     std::vector<ParticleJob> jobs;
-    std::vector<std::map<std::string, double>> batch_parsets;
+    std::vector<ParameterSet> batch_parsets;
 
     OperationType operation_to_perform;
 
@@ -181,5 +282,16 @@ class Storyteller {
 
     int simulation_serial;
     size_t batch_size;
+    size_t num_threads;                             ///< 0 selects the serial transmission mode
+    size_t ensemble_size;                           ///< Max realizations run together (1 disables ensembles)
+    size_t num_workers;                             ///< Particles simulated concurrently (1 disables workers)
+    size_t population_cache_size;                   ///< Max synthesized populations kept (0 disables reuse)
+    size_t checkpoint_interval;                     ///< Days between checkpoints (0 disables checkpoints)
+    std::string synthpop_path;                      ///< Binary population loaded by every simulation (empty to synthesize)
+    size_t branch_day;                              ///< First day simulated separately by each branch (0 disables branching)
+    size_t db_group_size;                           ///< Particles committed per transaction (0 disables the DatabaseWriter)
+    double db_group_seconds;                        ///< Longest a particle's results wait to be committed
+    size_t db_writer_megabytes;                     ///< Memory budget of the results waiting to be committed
+    std::string rng_backend;                        ///< Name of the generator used by every RngHandler
     std::string tome_path;
 };
\ No newline at end of file
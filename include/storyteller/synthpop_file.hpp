@@ -0,0 +1,66 @@
+/**
+ * @file synthpop_file.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the SynthpopFile class that writes synthesized populations to a
+ *        binary file and memory maps them back in place of synthesis.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "population.hpp"
+
+class RngHandler;
+
+/**
+ * @brief Read-only memory mapping of a binary synthetic population.
+ *
+ * The file starts with a Header that records how the population was generated
+ * (the values of Population::SYNTHESIS_PARAMETERS, including the seed), followed
+ * by one 64-byte aligned column per synthesized attribute: each agent's
+ * vaccination status and, for every strain, susceptibility and vaccine
+ * protection. The mapping is shared, so every process on a node that maps the
+ * same file reads it through a single copy in the page cache.
+ */
+class SynthpopFile {
+  public:
+    struct Header {
+        static constexpr uint32_t MAGIC   = 0x50505453; // "STPP"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr size_t N_COLUMNS = 1 + 2 * NUM_STRAIN_TYPES;
+
+        uint32_t magic;
+        uint32_t version;
+        uint64_t pop_size;
+        uint64_t synthesis_time;
+        uint64_t vaccinated;
+        uint32_t rng_backend;
+        uint32_t common_random_numbers;
+        double parameters[Population::SYNTHESIS_PARAMETERS.size()]; // in Population::SYNTHESIS_PARAMETERS order
+        uint64_t column_offsets[N_COLUMNS];                         // status, susceptibility[strain], vaccine protection[strain]
+    };
+
+    SynthpopFile(const std::string& path);
+    ~SynthpopFile();
+
+    SynthpopFile(const SynthpopFile&) = delete;
+    SynthpopFile& operator=(const SynthpopFile&) = delete;
+
+    const Header& get_header() const;
+
+    size_t load_into(Population& population, const std::vector<double>& key, size_t time) const;
+
+    static void write(const std::string& path, const Population& population, const std::vector<double>& key,
+                      const RngHandler* rng_handler, size_t time);
+
+  private:
+    template<typename T> const T* column(size_t c) const;
+
+    std::string path;
+    const void* mapping;
+    size_t n_bytes;
+};
\ No newline at end of file
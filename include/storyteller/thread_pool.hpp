@@ -0,0 +1,64 @@
+/**
+ * @file thread_pool.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the ThreadPool class that runs the chunked work of a simulation
+ *        tick across a fixed set of worker threads.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads for data-parallel loops.
+ *
+ * The worker threads are not started until the first parallel_for() that can
+ * use them, and they persist across simulations until shutdown() is called (or
+ * the pool is destroyed). The calling thread always takes part in the work, so a
+ * pool of n threads spawns n - 1 workers.
+ */
+class ThreadPool {
+  public:
+    ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    /**
+     * @brief Run task(i) for every i in [0, n_tasks) and wait until all are done.
+     *
+     * Tasks are handed out dynamically, so no task may depend on which thread
+     * runs it or on the order in which tasks run.
+     */
+    void parallel_for(size_t n_tasks, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief Stop and join all worker threads.
+     */
+    void shutdown();
+
+    size_t size() const;
+
+  private:
+    void start();
+    void worker_loop(size_t seen_generation);
+    void run_tasks();
+
+    size_t num_threads;
+    std::vector<std::thread> workers;
+
+    std::mutex mtx;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+
+    const std::function<void(size_t)>* current_task;
+    size_t n_current_tasks;
+    std::atomic<size_t> next_task;
+    size_t n_finished;  // workers that have finished the current generation
+    size_t generation;
+    bool stopping;
+};
\ No newline at end of file
@@ -9,24 +9,46 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <filesystem>
 
 #define SOL_ALL_SAFETIES_ON 1
 #include <sol/sol.hpp>
 
+#include "parameter_set.hpp"
+
 namespace fs = std::filesystem;
 
+namespace checkpoint { class Reader; }
+
+/**
+ * @brief Loads and stores the user configuration (the core tome and its
+ *        parameter and metric configs).
+ *
+ * A Tome is normally loaded by running the Lua config files. `--init` also
+ * compiles it into a binary snapshot next to the tome file, which simulation
+ * processes load instead (see load_compiled()) as long as none of the Lua files
+ * have changed. A compiled Tome holds the scalar core elements, the parameter
+ * schema, the metric names, and the paths, but not the Lua parameter and metric
+ * tables, so it can only be used to simulate.
+ */
 class Tome {
   public:
     Tome(sol::state* lua_vm, std::string path);
     ~Tome() = default;
 
+    static fs::path compiled_path(const fs::path& tome_path);
+    static std::unique_ptr<Tome> load_compiled(sol::state* lua_vm, std::string path);
+    void compile() const;
+
     std::map<std::string, sol::object> get_config_core() const;
     std::map<std::string, sol::object> get_config_params() const;
     std::map<std::string, sol::object> get_config_metrics() const;
 
     sol::object get_element(std::string key) const;
+    bool has_element(std::string key) const;
 
     template<typename T = double>
     T get_element_as(std::string key) const {
@@ -35,12 +57,20 @@ class Tome {
 
     std::string get_path(std::string key) const;
 
+    const ParameterSchema* get_parameter_schema() const;
+    const std::vector<std::string>& get_metric_names() const;
+
+    bool validate_parameter(size_t slot, double value) const;
+
     void clean();
 
   private:
+    Tome(sol::state* lua_vm, std::string path, checkpoint::Reader& compiled);
+
     bool check_for_req_items(sol::table core_tome_table);
     void slurp_table(sol::table& from, std::map<std::string, sol::object>& into);
     void determine_paths();
+    void compile_parameter_schema();
 
     std::map<std::string, sol::object> config_core;
     std::map<std::string, sol::object> config_params;
@@ -51,5 +81,9 @@ class Tome {
     const fs::path tome_path;
     std::map<std::string, fs::path> paths;
 
+    ParameterSchema parameter_schema;
+    std::vector<sol::protected_function> validators; // [slot] empty if the parameter has none
+    std::vector<std::string> metric_names;
+
     sol::state* vm;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * @file transmission_kernel.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the vectorized kernel that decides the outcome of a batch of
+ *        exposures and the runtime selection of its instruction set.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bit flags describing the outcome of a single exposure.
+ */
+enum InfectionOutcome : uint8_t {
+    NOT_INFECTED   = 0,
+    INFECTED       = 1 << 0,
+    HAS_SYMPTOMS   = 1 << 1,  ///< only meaningful if INFECTED
+    SEEKS_CARE     = 1 << 2   ///< only meaningful if INFECTED (implies HAS_SYMPTOMS)
+};
+
+/**
+ * @brief Instruction sets that the transmission kernel is compiled for.
+ */
+enum KernelIsa {
+    SCALAR,
+    AVX2,
+    AVX512,
+    NUM_KERNEL_ISAS
+};
+
+/**
+ * @brief Structure-of-arrays view of a batch of exposures, gathered from the
+ *        Population so the kernel only streams through contiguous arrays.
+ */
+struct InfectionBatch {
+    size_t n;
+    const double* susceptibility;     ///< current susceptibility (0 if not susceptible)
+    const double* vaccine_protection; ///< remaining vaccine protection (0 if unvaccinated)
+    const double* pr_symptoms;
+    const double* pr_careseeking;
+    const double* u_infection;
+    const double* u_symptoms;
+    const double* u_careseeking;
+    uint8_t* outcomes;                ///< InfectionOutcome flags written by the kernel
+};
+
+/**
+ * @brief Evaluates infection, symptom, and care-seeking outcomes for a batch of
+ *        exposures.
+ *
+ * An exposure infects if u_infection < susceptibility * (1 - vaccine_protection),
+ * which is exactly the scalar test in Person::attempt_infection. Every ISA performs
+ * the same IEEE operations in the same order (this file is built without floating
+ * point contraction), so the outcomes are identical whichever ISA is selected.
+ */
+namespace transmission_kernel {
+    /**
+     * @brief Evaluate a batch with the best ISA supported by this CPU.
+     */
+    void evaluate(const InfectionBatch& batch);
+
+    /**
+     * @brief Evaluate a batch with a specific ISA (must be supported by this CPU).
+     */
+    void evaluate(const InfectionBatch& batch, KernelIsa isa);
+
+    /**
+     * @brief Best ISA supported by this CPU, detected once at runtime.
+     */
+    KernelIsa best_isa();
+
+    bool is_supported(KernelIsa isa);
+    const char* isa_name(KernelIsa isa);
+}
\ No newline at end of file
@@ -8,7 +8,10 @@
  */
 #pragma once
 
+#include <array>
 #include <vector>
+#include <string>
+#include <memory_resource>
 
 #include <gsl/gsl_rng.h>
 
@@ -35,6 +38,20 @@ template<typename T> using vector2d = std::vector<std::vector<T>>;
  */
 template<typename T> using vector3d = std::vector<std::vector<std::vector<T>>>;
 
+/**
+ * @brief Two-dimensional vector that allocates from a polymorphic memory resource.
+ *
+ * @tparam T Type of the value stored
+ */
+template<typename T> using pmr_vector2d = std::pmr::vector<std::pmr::vector<T>>;
+
+/**
+ * @brief Three-dimensional vector that allocates from a polymorphic memory resource.
+ *
+ * @tparam T Type of the value stored
+ */
+template<typename T> using pmr_vector3d = std::pmr::vector<std::pmr::vector<std::pmr::vector<T>>>;
+
 /**
  * @brief Contains any useful utility functions.
  */
@@ -65,6 +82,12 @@ namespace util {
 
     extern double exp_decay_rate_from_half_life(const double half_life);
     extern double exp_decay(const double rate, const double time);
+
+    /**
+     * @brief Combines a seed with three stream coordinates (eg, purpose, day and
+     *        chunk) into a well-mixed seed for an independent random number stream.
+     */
+    extern unsigned long int mix_seed(unsigned long int seed, size_t a, size_t b, size_t c);
 }
 
 /**
@@ -78,15 +101,48 @@ enum RngType {
     NUM_RNG_TYPES
 };
 
+/**
+ * @brief Defines the generator algorithms that the RngHandler can be backed by.
+ */
+enum RngBackend {
+    PHILOX,   ///< Philox4x32-10 counter-based generator (default)
+    MT19937,  ///< GSL Mersenne Twister
+    NUM_RNG_BACKENDS
+};
+
+/**
+ * @brief Random decisions that are keyed by (seed, agent, day, purpose) in the
+ *        common random numbers mode.
+ *
+ * Each Philox block holds four consecutive draws, so the draws made together
+ * (eg, all of an agent's transmission draws on a day) share one block.
+ */
+enum CrnDraw {
+    CRN_EXPOSURE,            // block 0: transmission
+    CRN_INFECTION,
+    CRN_SYMPTOMS,
+    CRN_CARE_SEEKING,
+    CRN_VACCINATION,         // block 1: synthesis
+    CRN_SUSCEPTIBILITY,      // + strain
+    CRN_VAX_EFFECT = 8,      // block 2: synthesis, + strain
+    NUM_CRN_DRAWS  = 12
+};
+
+namespace checkpoint { class Writer; class Reader; }
+
 /**
  * @brief Handles all pseudo-random number generation and related operations.
  * 
  * Will store a separate pseudo-random number generator for each RngType and will
  * initialize each generator with the seed provided by the Storyteller.
+ *
+ * Draws should be made in bulk with the fill_* methods wherever the number of
+ * draws is known ahead of time; with the Philox backend uniforms are then
+ * generated many blocks at a time instead of one call per draw.
  */
 class RngHandler {
   public:
-    RngHandler();
+    RngHandler(RngBackend backend = PHILOX);
     ~RngHandler();
 
     void set_seed(const unsigned long int seed);
@@ -94,9 +150,33 @@ class RngHandler {
     double draw_from_rng(RngType type = INFECTION) const;
     gsl_rng* get_rng(RngType type = INFECTION) const;
 
+    void fill_uniform(RngType type, double* out, size_t n) const;
+    void fill_gaussian(RngType type, double* out, size_t n, double sigma) const;
+    void fill_beta(RngType type, double* out, size_t n, double a, double b) const;
+
+    static void fill_uniform(gsl_rng* r, double* out, size_t n);
+    static void fill_gaussian(gsl_rng* r, double* out, size_t n, double sigma);
+    static void fill_beta(gsl_rng* r, double* out, size_t n, double a, double b);
+
+    static RngBackend backend_from_name(const std::string& name);
+
+    RngBackend get_backend() const;
+    const gsl_rng_type* get_backend_type() const;
+
+    void seed_stream(gsl_rng* stream, RngType purpose, size_t time, size_t chunk) const;
+
+    void set_common_random_numbers(bool crn);
+    bool uses_common_random_numbers() const;
+    std::array<double, 4> keyed_block(size_t agent, size_t day, size_t block) const;
+
     unsigned long int get_seed() const;
 
+    void save_state(checkpoint::Writer& out) const;
+    void load_state(checkpoint::Reader& in) const;
+
   private:
+    RngBackend backend;
+    bool common_random_numbers;
     unsigned long int rng_seed;
     gsl_rng* infection_rng;
     gsl_rng* vaccination_rng;
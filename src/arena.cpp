@@ -0,0 +1,68 @@
+/**
+ * @file arena.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the SimulationArena class that provides the memory used by the
+ *        population, infection records, and ledger of a simulation.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+
+#include <storyteller/arena.hpp>
+
+void* SimulationArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) {
+    bytes_allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void SimulationArena::OverflowResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool SimulationArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+SimulationArena::SimulationArena(size_t initial_bytes)
+    : capacity(0),
+      high_water_mark(0) {
+    reserve(initial_bytes);
+}
+
+SimulationArena::~SimulationArena() {
+    // the monotonic resource returns its overflow chunks before the buffer goes away
+    resource.reset();
+}
+
+std::pmr::memory_resource* SimulationArena::get_resource() { return resource.get(); }
+
+void SimulationArena::rewind() {
+    const auto used = capacity + overflow.bytes_allocated;
+    high_water_mark = std::max(high_water_mark, used);
+
+    if (overflow.bytes_allocated > 0) {
+        // grow the retained buffer so the next simulation fits without overflowing
+        reserve(high_water_mark);
+    } else {
+        resource->release();
+    }
+}
+
+size_t SimulationArena::get_capacity() const { return capacity; }
+size_t SimulationArena::get_high_water_mark() const { return high_water_mark; }
+
+void SimulationArena::reserve(size_t bytes) {
+    resource.reset();
+    overflow.bytes_allocated = 0;
+
+    if (bytes > capacity) {
+        buffer   = std::make_unique<std::byte[]>(bytes);
+        capacity = bytes;
+    }
+
+    resource = (capacity > 0)
+                   ? std::make_unique<std::pmr::monotonic_buffer_resource>(buffer.get(), capacity, &overflow)
+                   : std::make_unique<std::pmr::monotonic_buffer_resource>(&overflow);
+}
\ No newline at end of file
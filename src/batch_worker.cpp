@@ -0,0 +1,147 @@
+/**
+ * @file batch_worker.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the BatchWorker object that simulates particles of a batch on
+ *        its own thread.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include <storyteller/batch_worker.hpp>
+#include <storyteller/storyteller.hpp>
+#include <storyteller/tome.hpp>
+#include <storyteller/ensemble.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/utility.hpp>
+#include <storyteller/database_handler.hpp>
+#include <storyteller/arena.hpp>
+
+BatchWorker::BatchWorker(const Storyteller* storyteller, std::map<std::string, bool> flags,
+                         std::string backend, std::mutex* writer_mutex, PopulationCache* cache)
+    : owner(storyteller),
+      simulation_flags(flags),
+      rng_backend(backend),
+      writer(writer_mutex),
+      population_cache(cache),
+      checkpoint_interval(0),
+      synthpop(nullptr),
+      ensemble_size(1) {
+    arena = std::make_unique<SimulationArena>();
+}
+
+BatchWorker::~BatchWorker() {}
+
+void BatchWorker::set_checkpoint_interval(size_t days) { checkpoint_interval = days; }
+
+void BatchWorker::set_synthpop(const SynthpopFile* file) { synthpop = file; }
+
+void BatchWorker::set_ensemble_size(size_t n_realizations) { ensemble_size = n_realizations; }
+
+/**
+ * @details Simulates the realizations of one particle (a single realization when
+ *          ensembles are disabled) exactly as Storyteller::ensemble_simulation
+ *          would. The worker's context is created for its first ensemble and
+ *          reset in place for every later one: the RngHandlers are reseeded, the
+ *          parameter values are overwritten, and the Ensemble's Simulators reuse
+ *          their storage. Jobs are started and ended, and results written, while
+ *          holding #writer; the simulation itself runs without it.
+ *
+ * @return false The simulations were checkpointed and stopped early on SIGTERM
+ */
+bool BatchWorker::run(const int serial_start, const std::vector<size_t>& indices,
+                      const std::vector<ParameterSet>& batch_parsets, std::vector<ParticleJob>& jobs) {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+
+    if (not ensemble) { init_simulation_context(serial_start, batch_parsets); }
+
+    std::vector<size_t> serials;
+    {
+        std::lock_guard<std::mutex> lock(*writer);
+        for (size_t r = 0; r < indices.size(); ++r) {
+            const size_t serial = serial_start + indices[r];
+            rng_handlers[r]->set_seed(batch_parsets[indices[r]][SEED]);
+
+            if (hpc_mode) {
+                jobs[indices[r]].start();
+            } else {
+                db_handlers[r]->start_job(serial);
+            }
+            serials.push_back(serial);
+        }
+    }
+
+    const auto first = indices.front();
+    parameters->read_parameters_from_batch(serial_start + first, batch_parsets[first]);
+
+    if (not parameters->are_valid()) {
+        std::cerr << "ERROR: invalid parameters for serial " << serial_start + first << '\n';
+        exit(-1);
+    }
+
+    ensemble->reset(serials);
+    ensemble->init();
+    if (simulation_flags.at("resume")) { ensemble->resume(); }
+    ensemble->simulate();
+
+    const bool completed = not ensemble->was_interrupted();
+
+    if (completed) {
+        std::lock_guard<std::mutex> lock(*writer);
+        ensemble->results();
+        for (size_t r = 0; r < indices.size(); ++r) {
+            if (hpc_mode) {
+                jobs[indices[r]].end();
+            } else {
+                db_handlers[r]->end_job(serial_start + indices[r]);
+            }
+        }
+    }
+
+    return completed;
+}
+
+/**
+ * @details Creates the #rng_handlers, #db_handlers, #parameters, and #ensemble
+ *          that every ensemble the worker simulates reuses. The Ensemble is
+ *          created with #ensemble_size realizations and the largest population
+ *          and simulation duration in the batch, so that no ensemble has to grow
+ *          its storage.
+ */
+void BatchWorker::init_simulation_context(const int serial_start, const std::vector<ParameterSet>& batch_parsets) {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+
+    ParameterSet largest = batch_parsets.front();
+    for (const auto& pars : batch_parsets) {
+        largest[POP_SIZE]     = std::max(largest[POP_SIZE], pars[POP_SIZE]);
+        largest[SIM_DURATION] = std::max(largest[SIM_DURATION], pars[SIM_DURATION]);
+    }
+
+    std::vector<Ensemble::Realization> realizations;
+    {
+        std::lock_guard<std::mutex> lock(*writer);
+        for (size_t r = 0; r < ensemble_size; ++r) {
+            rng_handlers.push_back(std::make_unique<RngHandler>(RngHandler::backend_from_name(rng_backend)));
+            rng_handlers.back()->set_common_random_numbers(simulation_flags.at("crn"));
+
+            DatabaseHandler* dbh = nullptr;
+            if (not hpc_mode) {
+                db_handlers.push_back(std::make_unique<DatabaseHandler>(owner));
+                dbh = db_handlers.back().get();
+            }
+            realizations.push_back({(size_t) serial_start, rng_handlers.back().get(), dbh});
+        }
+    }
+
+    parameters = std::make_unique<Parameters>(rng_handlers.front().get(), realizations.front().db_handler,
+                                              owner->get_tome());
+    parameters->read_parameters_from_batch(serial_start, largest);
+
+    ensemble = std::make_unique<Ensemble>(parameters.get(), realizations, arena.get());
+    ensemble->set_flags(simulation_flags);
+    ensemble->set_population_cache(population_cache);
+    ensemble->set_checkpoint_interval(checkpoint_interval);
+    ensemble->set_synthpop(synthpop);
+}
\ No newline at end of file
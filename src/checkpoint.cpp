@@ -0,0 +1,127 @@
+/**
+ * @file checkpoint.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the binary reader and writer used to checkpoint a running
+ *        simulation, and the SIGTERM handling that triggers a final checkpoint.
+ *
+ * @copyright TBD
+ */
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <storyteller/checkpoint.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<bool> termination_signaled(false);
+static_assert(std::atomic<bool>::is_always_lock_free, "the termination flag must be safe to set from a signal handler");
+
+extern "C" void signal_termination(int) { termination_signaled = true; }
+
+} // namespace
+
+namespace checkpoint {
+
+bool Header::is_compatible(const Header& other) const {
+    return (magic == other.magic)
+       and (version == other.version)
+       and (serial == other.serial)
+       and (seed == other.seed)
+       and (pop_size == other.pop_size)
+       and (sim_duration == other.sim_duration)
+       and (rng_backend == other.rng_backend)
+       and (common_random_numbers == other.common_random_numbers)
+       and (n_chunks == other.n_chunks);
+}
+
+Writer::Writer(const fs::path& checkpoint_path)
+    : path(checkpoint_path),
+      tmp_path(checkpoint_path) {
+    tmp_path += ".tmp";
+    fs::create_directories(path.parent_path());
+    out.open(tmp_path, std::ios::binary | std::ios::trunc);
+    if (not out) {
+        std::cerr << "ERROR: could not open checkpoint " << tmp_path << " for writing\n";
+        exit(-1);
+    }
+}
+
+Writer::~Writer() {
+    // a writer that was never committed leaves the previous checkpoint in place
+    if (out.is_open()) {
+        out.close();
+        std::error_code ec;
+        fs::remove(tmp_path, ec);
+    }
+}
+
+void Writer::write(const std::string& value) {
+    write(value.size());
+    write_bytes(value.data(), value.size());
+}
+
+void Writer::write_bytes(const void* data, size_t n_bytes) {
+    out.write(reinterpret_cast<const char*>(data), n_bytes);
+}
+
+/**
+ * @details The rename replaces the previous checkpoint atomically on POSIX
+ *          filesystems.
+ */
+void Writer::commit() {
+    out.close();
+    if (out.fail()) {
+        std::cerr << "ERROR: could not write checkpoint " << tmp_path << '\n';
+        exit(-1);
+    }
+    fs::rename(tmp_path, path);
+}
+
+Reader::Reader(const fs::path& checkpoint_path)
+    : path(checkpoint_path),
+      in(checkpoint_path, std::ios::binary) {
+    if (not in) {
+        std::cerr << "ERROR: could not open checkpoint " << path << '\n';
+        exit(-1);
+    }
+}
+
+void Reader::read(std::string& value) {
+    size_t n = 0;
+    read(n);
+    value.resize(n);
+    read_bytes(value.data(), n);
+}
+
+void Reader::read_bytes(void* data, size_t n_bytes) {
+    in.read(reinterpret_cast<char*>(data), n_bytes);
+    if (not in) {
+        std::cerr << "ERROR: checkpoint " << path << " is truncated or corrupt\n";
+        exit(-1);
+    }
+}
+
+Header read_header(const fs::path& path) {
+    Header header;
+    Reader(path).read(header);
+    if ((header.magic != Header::MAGIC) or (header.version != Header::VERSION)) {
+        std::cerr << "ERROR: " << path << " is not a version " << Header::VERSION << " checkpoint\n";
+        exit(-1);
+    }
+    return header;
+}
+
+/**
+ * @details SIGTERM only sets a flag; simulations check it once per simulated day,
+ *          write a checkpoint, and stop.
+ */
+void install_termination_handler() { std::signal(SIGTERM, signal_termination); }
+
+bool termination_requested() { return termination_signaled; }
+
+} // namespace checkpoint
\ No newline at end of file
@@ -7,6 +7,7 @@
  * @copyright TBD
  */
 #include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include <gsl/gsl_randist.h>
@@ -14,43 +15,176 @@
 #include <storyteller/community.hpp>
 #include <storyteller/parameters.hpp>
 #include <storyteller/person.hpp>
+#include <storyteller/kinetics.hpp>
+#include <storyteller/population.hpp>
 #include <storyteller/simulator.hpp>
 #include <storyteller/utility.hpp>
 #include <storyteller/ledger.hpp>
+#include <storyteller/thread_pool.hpp>
+#include <storyteller/population_cache.hpp>
+#include <storyteller/synthpop_file.hpp>
+#include <storyteller/checkpoint.hpp>
+#include <storyteller/transmission_kernel.hpp>
 
-Community::Community(const Parameters* parameters, const RngHandler* rng_handler) {
+Community::Community(const Parameters* parameters, const RngHandler* rng_handler, std::pmr::memory_resource* resource)
+    : exposures(resource),
+      chosen(resource),
+      pool(nullptr),
+      population_cache(nullptr),
+      synthpop(nullptr),
+      mem(resource) {
     par = parameters;
     rng = rng_handler;
 
-    ledger = std::make_unique<Ledger>(par);
-    
-    people.reserve(par->get("pop_size"));
+    ledger = std::make_unique<Ledger>(par, mem);
+
     init_population();
 }
 
-Community::~Community() {}
+Community::~Community() {
+    for (auto r : chunk_rngs) { gsl_rng_free(r); }
+}
+
+/**
+ * @details Switches transmission to the chunked parallel mode. The population is
+ *          split into fixed-size chunks, and each chunk gets its own random number
+ *          stream and ledger tally so chunks can be processed independently. Must
+ *          be called before the simulation is initialized (see init_eligible_agents).
+ */
+void Community::set_thread_pool(ThreadPool* thread_pool) {
+    pool = thread_pool;
+    if (pool) { resize_chunks(); }
+}
+
+/**
+ * @details Keeps one stream, buffer, and tally per chunk of the current
+ *          population, reusing those of the previous simulation.
+ */
+void Community::resize_chunks() {
+    const size_t n_chunks = (population->size() + TRANSMISSION_CHUNK_SIZE - 1) / TRANSMISSION_CHUNK_SIZE;
+    while (chunk_rngs.size() > n_chunks) {
+        gsl_rng_free(chunk_rngs.back());
+        chunk_rngs.pop_back();
+    }
+    while (chunk_rngs.size() < n_chunks) { chunk_rngs.push_back(gsl_rng_alloc(rng->get_backend_type())); }
+    // chunks grow their buffers concurrently, so they cannot share the arena
+    chunk_exposures.resize(n_chunks, std::pmr::vector<Exposure>(std::pmr::get_default_resource()));
+    chunk_chosen.resize(n_chunks, std::pmr::vector<uint8_t>(std::pmr::get_default_resource()));
+    chunk_batches.resize(n_chunks);
+    chunk_tallies.resize(n_chunks);
+}
+
+/**
+ * @details Returns the community to its state before init() for the current
+ *          parameters (eg, after the Parameters it points to were overwritten
+ *          with the next particle's values), reusing the population, ledger, and
+ *          transmission storage of the previous simulation.
+ */
+void Community::reset() {
+    population->reset();
+    ledger->reset();
+    exposures.clear();
+    if (pool) { resize_chunks(); }
+}
 
 void Community::init_population() {
-    for (size_t i = 0; i < par->get("pop_size"); ++i) {
-        people.push_back(std::make_unique<Person>(i, par, rng));
-        Person* p = people.back().get();
+    population = std::make_unique<Population>(par, rng, mem);
+}
 
-        susceptibles.push_back(p);
+/**
+ * @details Must be called once the population's susceptibility and vaccination
+ *          are final (ie, after synthesize_population) and after any ThreadPool has
+ *          been set. In parallel mode each chunk keeps its own set of eligible
+ *          agents so that chunks never share state. Agents who start out immune
+ *          to every strain for good are never eligible.
+ *
+ *          An agent infected on day t is parked until day t + ceil(refractory
+ *          period), the first day Person::is_susceptible_to allows reinfection.
+ *          Agents whose refractory period outlasts the simulation are removed.
+ */
+void Community::init_eligible_agents() {
+    const auto kinetics = par->get_kinetics();
+    const size_t sim_duration = par->get(SIM_DURATION);
+
+    size_t max_delay = 0;
+    refractory_days.resize(NUM_STRAIN_TYPES);
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        const double refractory_period = std::max(0.0, kinetics->refractory_period((StrainType) s));
+        refractory_days[s] = std::min((size_t) std::ceil(refractory_period), sim_duration);
+        max_delay = std::max(max_delay, refractory_days[s]);
+    }
+
+    auto prune = [&](EligibleAgents& set, size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (is_permanently_immune(i)) { set.remove(i); }
+        }
+    };
+
+    const size_t pop_size = population->size();
+    if (pool) {
+        chunk_eligible.clear();
+        chunk_eligible.reserve(chunk_rngs.size());
+        for (size_t chunk = 0; chunk < chunk_rngs.size(); ++chunk) {
+            const size_t first = chunk * TRANSMISSION_CHUNK_SIZE;
+            const size_t last  = std::min(first + TRANSMISSION_CHUNK_SIZE, pop_size);
+            // chunks update their sets concurrently, so they cannot share the arena
+            chunk_eligible.emplace_back(first, last, max_delay, std::pmr::get_default_resource());
+            prune(chunk_eligible.back(), first, last);
+        }
+    } else {
+        if (eligible) {
+            eligible->reset(0, pop_size, max_delay);
+        } else {
+            eligible = std::make_unique<EligibleAgents>(0, pop_size, max_delay, mem);
+        }
+        prune(*eligible, 0, pop_size);
     }
 }
 
-void Community::transmission(size_t time) {
-    auto strain_sample = par->daily_strain_sample(time);
-    for (auto& p : people) {
-        auto strain = strain_sample.back();
-        strain_sample.pop_back();
+bool Community::is_permanently_immune(size_t agent) const {
+    const auto p = (*population)[agent];
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        if (not p.is_permanently_immune_to((StrainType) s)) { return false; }
+    }
+    return true;
+}
+
+/**
+ * @details Takes a newly infected agent out of the eligible set, either for good
+ *          or until their refractory period ends.
+ */
+void Community::retire_infected(EligibleAgents& eligible_agents, const Exposure& exposure, size_t time) {
+    const auto& [agent, strain] = exposure;
+    if (is_permanently_immune(agent)) {
+        eligible_agents.remove(agent);
+        return;
+    }
+
+    const size_t delay = refractory_days[strain];
+    if (delay == 0) { return; }
 
-        if (strain == NUM_STRAIN_TYPES) continue;
-        // determine if infection occurs
-        auto infection_occurs = p->attempt_infection(strain, time);
-        if (infection_occurs) ledger->log_infection(infection_occurs);
+    if (time + delay < par->get(SIM_DURATION)) {
+        eligible_agents.park(agent, time + delay);
+    } else {
+        eligible_agents.remove(agent);
+    }
+}
+
+void Community::transmission(size_t time) {
+    if (pool) {
+        parallel_transmission(time);
+        return;
     }
 
+    // only the agents exposed today are visited, and all of their draws are made in bulk
+    const size_t n = sample_exposures(time);
+    batch.resize(n);
+    stage_exposures(exposures, time, rng->get_rng(INFECTION), rng->get_rng(BEHAVIOR), batch, 0);
+
+    // determine which exposures lead to infection
+    transmission_kernel::evaluate(batch.view());
+    apply_outcomes(time, batch.outcomes.data());
+
     // old method that samples a single strain per person (keeping for reference)
     // for (auto& p : people) {
     //     // determine if exposure with occurs
@@ -62,21 +196,256 @@ void Community::transmission(size_t time) {
     // }
 }
 
-void Community::vaccinate_population(size_t time) {
-    auto pr_vaccination = par->get("pr_vax");
-    if (pr_vaccination == 0) { return; }
-    for (auto& p : people) {
-        if (rng->draw_from_rng(VACCINATION) < pr_vaccination) {
-            p->vaccinate(time);
-            ledger->vax_incidence[time]++;
+/**
+ * @details Re-admits the agents whose refractory period ends today, then samples
+ *          the day's exposures among the eligible agents (serial mode only).
+ *
+ * @return size_t Number of exposures
+ */
+size_t Community::sample_exposures(size_t time) {
+    eligible->release(time);
+    if (rng->uses_common_random_numbers()) {
+        sample_keyed_exposures(time, eligible->get_agents(), exposures);
+    } else {
+        par->sample_daily_exposures(time, eligible->get_agents(), rng->get_rng(INFECTION), exposures, chosen);
+    }
+    return exposures.size();
+}
+
+/**
+ * @details Common random numbers mode: each candidate is exposed to the strain
+ *          that their keyed exposure draw for the day falls in (the same
+ *          categorical distribution that sample_daily_exposures draws from). This
+ *          visits every candidate, rather than only the exposed ones, so that
+ *          whether an agent is exposed does not depend on anyone else.
+ */
+void Community::sample_keyed_exposures(size_t time, const std::pmr::vector<size_t>& candidates,
+                                       std::pmr::vector<Exposure>& exposed) const {
+    const auto& strain_probs = par->strain_probs[time];
+
+    exposed.clear();
+    for (auto agent : candidates) {
+        const double u = rng->keyed_block(agent, time, CRN_EXPOSURE / 4)[CRN_EXPOSURE % 4];
+
+        double cumulative = 0.0;
+        for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+            cumulative += strain_probs[s];
+            if (u < cumulative) {
+                exposed.push_back({agent, (StrainType) s});
+                break;
+            }
+        }
+    }
+    std::sort(exposed.begin(), exposed.end(), [](const Exposure& a, const Exposure& b) { return a.agent < b.agent; });
+}
+
+/**
+ * @details Records the infections decided by the transmission kernel for the
+ *          day's exposures (serial mode only).
+ */
+void Community::apply_outcomes(size_t time, const uint8_t* outcomes) {
+    for (size_t i = 0; i < exposures.size(); ++i) {
+        const auto outcome = outcomes[i];
+        if (not (outcome & INFECTED)) continue;
+
+        const auto& [agent, strain] = exposures[i];
+        const auto sympt = (outcome & HAS_SYMPTOMS) ? SYMPTOMATIC : ASYMPTOMATIC;
+        ledger->log_infection((*population)[agent].infect(strain, time, sympt, outcome & SEEKS_CARE));
+        retire_infected(*eligible, exposures[i], time);
+    }
+}
+
+/**
+ * @details Each chunk samples its own exposures and attempts its own infections
+ *          using a stream seeded from (seed, time, chunk), and logs into its own
+ *          tally. Chunks only write to their own agents' state, so they can run in
+ *          any order on any thread; the tallies are then merged in chunk order.
+ *          The results for a given seed are identical for any number of threads.
+ */
+void Community::parallel_transmission(size_t time) {
+    const bool record = ledger->is_recording_infections();
+
+    pool->parallel_for(chunk_rngs.size(), [&](size_t chunk) {
+        auto stream = chunk_rngs[chunk];
+        rng->seed_stream(stream, INFECTION, time, chunk);
+
+        auto& chunk_eligible_agents = chunk_eligible[chunk];
+        chunk_eligible_agents.release(time);
+
+        auto& chunk_exposed = chunk_exposures[chunk];
+        if (rng->uses_common_random_numbers()) {
+            sample_keyed_exposures(time, chunk_eligible_agents.get_agents(), chunk_exposed);
+        } else {
+            par->sample_daily_exposures(time, chunk_eligible_agents.get_agents(), stream, chunk_exposed,
+                                        chunk_chosen[chunk]);
+        }
+
+        const size_t n = chunk_exposed.size();
+        auto& chunk_batch = chunk_batches[chunk];
+        chunk_batch.resize(n);
+        stage_exposures(chunk_exposed, time, stream, stream, chunk_batch, 0);
+        transmission_kernel::evaluate(chunk_batch.view());
+        for (size_t i = 0; i < n; ++i) {
+            const auto outcome = chunk_batch.outcomes[i];
+            if (not (outcome & INFECTED)) continue;
+
+            const auto& [agent, strain] = chunk_exposed[i];
+            const auto sympt = (outcome & HAS_SYMPTOMS) ? SYMPTOMATIC : ASYMPTOMATIC;
+            chunk_tallies[chunk].log_infection((*population)[agent].infect(strain, time, sympt, outcome & SEEKS_CARE), record);
+            retire_infected(chunk_eligible_agents, chunk_exposed[i], time);
         }
+    });
+
+    for (auto& tally : chunk_tallies) {
+        ledger->merge(tally, time);
+    }
+}
+
+/**
+ * @details Draws the uniforms for, and gathers each exposed agent's current
+ *          susceptibility (zero if they are not susceptible, eg during a refractory
+ *          period), remaining vaccine protection (zero if unvaccinated), and
+ *          symptom and care-seeking probabilities (see Population::gather_exposed)
+ *          into positions [offset, offset + exposed.size()) of the batch, so that
+ *          the transmission kernel can decide every outcome of the batch at once.
+ *          The kernel then makes exactly the decisions that
+ *          Person::attempt_infection would make with the same draws.
+ *
+ *          The infection and symptom draws come from the infection stream (in
+ *          that order) and the care-seeking draws from the behavior stream, except
+ *          in the common random numbers mode, where they are the exposed agent's
+ *          keyed draws for the day.
+ */
+void Community::stage_exposures(const std::pmr::vector<Exposure>& exposed, size_t time, gsl_rng* infection_stream,
+                                gsl_rng* behavior_stream, ExposureBatch& b, size_t offset) {
+    const size_t n = exposed.size();
+    if (rng->uses_common_random_numbers()) {
+        static_assert(CRN_EXPOSURE / 4 == CRN_CARE_SEEKING / 4, "transmission draws share a block");
+        for (size_t i = 0; i < n; ++i) {
+            const auto u = rng->keyed_block(exposed[i].agent, time, CRN_EXPOSURE / 4);
+            b.u_infection[offset + i]   = u[CRN_INFECTION % 4];
+            b.u_symptoms[offset + i]    = u[CRN_SYMPTOMS % 4];
+            b.u_careseeking[offset + i] = u[CRN_CARE_SEEKING % 4];
+        }
+    } else {
+        RngHandler::fill_uniform(infection_stream, b.u_infection.data() + offset, n);
+        RngHandler::fill_uniform(infection_stream, b.u_symptoms.data() + offset, n);
+        RngHandler::fill_uniform(behavior_stream, b.u_careseeking.data() + offset, n);
+    }
+
+    population->gather_exposed(exposed, time, b.susceptibility.data() + offset,
+                               b.vaccine_protection.data() + offset, b.pr_careseeking.data() + offset);
+
+    const double pr_symptoms[NUM_STRAIN_TYPES] = {par->get(PR_SYMPT_NONFLU), par->get(PR_SYMPT_FLU)};
+    for (size_t i = 0; i < n; ++i) {
+        b.pr_symptoms[offset + i] = pr_symptoms[exposed[i].strain];
+    }
+}
+
+void Community::ExposureBatch::resize(size_t n) {
+    susceptibility.resize(n);
+    vaccine_protection.resize(n);
+    pr_symptoms.resize(n);
+    pr_careseeking.resize(n);
+    u_infection.resize(n);
+    u_symptoms.resize(n);
+    u_careseeking.resize(n);
+    outcomes.resize(n);
+}
+
+InfectionBatch Community::ExposureBatch::view() {
+    return {
+        outcomes.size(),
+        susceptibility.data(),
+        vaccine_protection.data(),
+        pr_symptoms.data(),
+        pr_careseeking.data(),
+        u_infection.data(),
+        u_symptoms.data(),
+        u_careseeking.data(),
+        outcomes.data()
+    };
+}
+
+void Community::set_population_cache(PopulationCache* cache) { population_cache = cache; }
+
+void Community::set_synthpop(const SynthpopFile* file) { synthpop = file; }
+
+void Community::set_parameters(const Parameters* parameters) {
+    par = parameters;
+    population->set_parameters(parameters);
+    ledger->set_parameters(parameters);
+}
+
+/**
+ * @details Synthesizes the population's vaccination status, susceptibility, and
+ *          vaccine protection (see Population::synthesize), on the ThreadPool if
+ *          one is set. With a SynthpopFile, the population is loaded from the
+ *          file instead of synthesized. With a PopulationCache, a population
+ *          already synthesized for the same synthesis parameters, time, and seed
+ *          (this simulation's own, which differs between the realizations of an
+ *          ensemble that share one Parameters) is restored instead of sampled
+ *          again. Synthesis draws from its own streams, so either way the rest
+ *          of the simulation draws exactly the same numbers.
+ */
+void Community::synthesize_population(size_t time) {
+    if (synthpop) {
+        const auto key = Population::synthesis_key(par->get_values());
+        ledger->vax_incidence[time] += synthpop->load_into(*population, key, time);
+        return;
+    }
+
+    if (not population_cache) {
+        ledger->vax_incidence[time] += population->synthesize(time, pool);
+        return;
     }
+
+    auto key = Population::synthesis_key(par->get_values(), rng->get_seed());
+    key.push_back(time);
+
+    auto snapshot = population_cache->find(key);
+    if (snapshot) {
+        population->restore(*snapshot);
+    } else {
+        auto fresh = std::make_shared<PopulationSnapshot>();
+        fresh->key = key;
+        fresh->vaccinated = population->synthesize(time, pool);
+        population->save(*fresh);
+        population_cache->insert(fresh);
+        snapshot = fresh;
+    }
+    ledger->vax_incidence[time] += snapshot->vaccinated;
 }
 
-std::vector<Person*> Community::get_population() const {
-    std::vector<Person*> ret;
-    for (const auto& p : people) {
-        ret.push_back(p.get());
+Population* Community::get_population() const { return population.get(); }
+
+/**
+ * @details Writes the state carried from one day to the next: the population, the
+ *          eligible agents (one set per chunk in the parallel mode), and the
+ *          ledger. Day-to-day buffers and per-day chunk streams are not written.
+ */
+void Community::save_state(checkpoint::Writer& out) const {
+    population->save_state(out);
+    if (pool) {
+        for (const auto& set : chunk_eligible) { set.save_state(out); }
+    } else {
+        eligible->save_state(out);
     }
-    return ret;
-}
\ No newline at end of file
+    ledger->save_state(out);
+}
+
+/**
+ * @details Must be called after the community has been initialized in the same
+ *          transmission mode it was in when the checkpoint was written.
+ */
+void Community::load_state(checkpoint::Reader& in) {
+    population->load_state(in);
+    if (pool) {
+        for (auto& set : chunk_eligible) { set.load_state(in); }
+    } else {
+        eligible->load_state(in);
+    }
+    ledger->load_state(in, population.get());
+}
+
+size_t Community::get_n_chunks() const { return (pool) ? chunk_eligible.size() : 0; }
\ No newline at end of file
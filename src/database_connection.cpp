@@ -0,0 +1,180 @@
+/**
+ * @file database_connection.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the DatabaseConnection that keeps one long-lived SQLite
+ *        connection to the experiment database per process.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <storyteller/database_connection.hpp>
+
+namespace {
+
+std::mutex registry_mutex;
+std::map<std::string, std::unique_ptr<DatabaseConnection>> registry; // database path -> connection
+
+} // namespace
+
+DatabaseConnection::DatabaseConnection(const std::string& database_path)
+    : path(database_path),
+      journal_mode("WAL"),
+      owner_pid(0),
+      jitter(std::random_device{}()),
+      ms_waited_this_lock(0.0) {}
+
+/**
+ * @details A connection inherited from a parent process is deliberately leaked
+ *          (see database()), so only the process that opened it closes it.
+ */
+DatabaseConnection::~DatabaseConnection() {
+    if (owner_pid != getpid()) {
+        for (auto& [sql, stmt] : statements) { (void) stmt.release(); }
+        (void) db.release();
+    }
+}
+
+/**
+ * @details Connections live until the process exits, so the pointer can be kept
+ *          by any number of DatabaseHandlers.
+ */
+DatabaseConnection* DatabaseConnection::for_path(const std::string& database_path) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& connection = registry[database_path];
+    if (not connection) { connection.reset(new DatabaseConnection(database_path)); }
+    return connection.get();
+}
+
+void DatabaseConnection::report_counters(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& [database_path, connection] : registry) {
+        const auto c = connection->get_counters();
+        out << database_path << ": " << c.opens << " connection opens, "
+            << c.prepares << " statements prepared (" << c.cache_hits << " reused), "
+            << c.busy_waits << " lock waits, " << c.retries << " retries, "
+            << c.ms_lock_wait << " ms waiting for locks\n";
+    }
+}
+
+/**
+ * @details Only takes effect when the connection is (re)opened. WAL lets readers
+ *          proceed while a particle writes, but needs shared memory, so it should
+ *          be replaced (eg, by DELETE) on network filesystems that lack it.
+ */
+void DatabaseConnection::set_journal_mode(const std::string& mode) { journal_mode = mode; }
+
+/**
+ * @details Opens the connection on first use, and again in a forked child: a
+ *          SQLite connection must not be used across a fork, so the parent's is
+ *          leaked rather than closed (closing it could disturb the parent's
+ *          locks and WAL).
+ */
+SQLite::Database& DatabaseConnection::database(bool create) {
+    if (db and (owner_pid == getpid())) { return *db; }
+
+    if (db) {
+        for (auto& [sql, stmt] : statements) { (void) stmt.release(); }
+        (void) db.release();
+        // forked siblings would otherwise back off in lockstep
+        jitter.seed(std::random_device{}());
+    }
+    statements.clear();
+
+    const int flags = SQLite::OPEN_READWRITE | ((create) ? SQLite::OPEN_CREATE : 0);
+    db = std::make_unique<SQLite::Database>(path, flags);
+    owner_pid = getpid();
+    ++counters.opens;
+
+    sqlite3_busy_handler(db->getHandle(), &DatabaseConnection::busy_handler, this);
+    db->exec("PRAGMA journal_mode=" + journal_mode);
+    db->exec("PRAGMA synchronous=NORMAL");
+    db->exec("PRAGMA cache_size=-16384");
+    db->exec("PRAGMA temp_store=MEMORY");
+    return *db;
+}
+
+/**
+ * @details Statements are prepared once per connection and reset (with their
+ *          bindings cleared) every time they are handed out.
+ */
+SQLite::Statement& DatabaseConnection::statement(const std::string& sql) {
+    auto& connection = database();
+
+    auto& stmt = statements[sql];
+    if (stmt) {
+        ++counters.cache_hits;
+        stmt->reset();
+        stmt->clearBindings();
+    } else {
+        stmt = std::make_unique<SQLite::Statement>(connection, sql);
+        ++counters.prepares;
+    }
+    return *stmt;
+}
+
+std::recursive_mutex& DatabaseConnection::get_mutex() { return mutex; }
+
+/**
+ * @details Called between attempts of an operation that failed for a reason the
+ *          busy handler could not wait out (eg, it timed out). Callers have
+ *          released #mutex by then, so it is only held to draw the delay and
+ *          count the retry (the busy handler of another thread may be doing the
+ *          same), not while sleeping.
+ */
+void DatabaseConnection::backoff(size_t attempt) {
+    double delay_ms;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        delay_ms = jittered_delay_ms(attempt, MAX_DELAY_MS);
+        ++counters.retries;
+        counters.ms_lock_wait += delay_ms;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay_ms));
+}
+
+DatabaseConnection::Counters DatabaseConnection::get_counters() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return counters;
+}
+
+/**
+ * @brief Delay of BASE_DELAY_MS * 2^attempt (capped at max_ms), scaled by a
+ *        uniform jitter in [0.5, 1) so that waiting processes spread out. Must be
+ *        called while holding #mutex.
+ */
+double DatabaseConnection::jittered_delay_ms(size_t attempt, double max_ms) {
+    const double delay = std::min(max_ms, BASE_DELAY_MS * std::pow(2.0, std::min<size_t>(attempt, 20)));
+    return delay * std::uniform_real_distribution<double>(0.5, 1.0)(jitter);
+}
+
+/**
+ * @details SQLite calls this instead of failing with SQLITE_BUSY while another
+ *          connection holds a conflicting lock. Returning 0 gives up after
+ *          BUSY_TIMEOUT_MS of waiting for the same lock. It runs inside an
+ *          operation of this connection, so the calling thread holds #mutex.
+ */
+int DatabaseConnection::busy_handler(void* ptr, int n_prior_calls) {
+    auto connection = static_cast<DatabaseConnection*>(ptr);
+    if (n_prior_calls == 0) { connection->ms_waited_this_lock = 0.0; }
+    if (connection->ms_waited_this_lock >= BUSY_TIMEOUT_MS) { return 0; }
+
+    const auto delay_ms = connection->jittered_delay_ms(n_prior_calls, MAX_DELAY_MS);
+    connection->ms_waited_this_lock += delay_ms;
+    connection->counters.ms_lock_wait += delay_ms;
+    ++connection->counters.busy_waits;
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay_ms));
+    return 1;
+}
\ No newline at end of file
@@ -6,19 +6,24 @@
  *
  * @copyright TBD
  */
+#include <algorithm>
 #include <chrono>
-#include <thread>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
 #include <vector>
 #include <map>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #define SOL_ALL_SAFETIES_ON 1
 #include <sol/sol.hpp>
 #include <SQLiteCpp/SQLiteCpp.h>
 
 #include <storyteller/database_handler.hpp>
+#include <storyteller/database_connection.hpp>
+#include <storyteller/database_writer.hpp>
 #include <storyteller/ledger.hpp>
 #include <storyteller/storyteller.hpp>
 #include <storyteller/tome.hpp>
@@ -55,33 +60,69 @@ void ParticleJob::end() {
     status = "done";
 }
 
-std::string ParticleJob::update() {
-    std::ostringstream sql("UPDATE job SET ", std::ios_base::ate);
-    sql << "status='"      << status << "', "
-        << "attempts="      << attempts << ", "
-        << "completions="  << completions << ", "
-        << "start_time="   << start_time << ", "
-        << "duration="     << duration << " "
-        << "WHERE serial=" << serial << ";";
-    return sql.str();
+/**
+ * @details Copies the cumulative counts of every day in the order of the met
+ *          table's columns, so that the Ledger can be reset for the next
+ *          simulation while the block waits to be written.
+ */
+MetricsBlock::MetricsBlock(size_t serial, const Ledger* ledger, size_t n_days)
+    : serial(serial),
+      replace(false),
+      counts(n_days * NUM_COUNTS),
+      tnd_ve_est(ledger->get_tnd_ve_est().begin(), ledger->get_tnd_ve_est().begin() + n_days) {
+    const auto& infs = ledger->get_cumul_infs();
+    const auto& mais = ledger->get_cumul_mais();
+    for (size_t t = 0; t < n_days; ++t) {
+        auto day = counts.begin() + t * NUM_COUNTS;
+        day[0] = infs[VACCINATED][INFLUENZA][t];
+        day[1] = infs[VACCINATED][NON_INFLUENZA][t];
+        day[2] = infs[UNVACCINATED][INFLUENZA][t];
+        day[3] = infs[UNVACCINATED][NON_INFLUENZA][t];
+        day[4] = mais[VACCINATED][INFLUENZA][t];
+        day[5] = mais[VACCINATED][NON_INFLUENZA][t];
+        day[6] = mais[UNVACCINATED][INFLUENZA][t];
+        day[7] = mais[UNVACCINATED][NON_INFLUENZA][t];
+    }
+}
+
+size_t MetricsBlock::n_days() const { return tnd_ve_est.size(); }
+
+size_t MetricsBlock::bytes() const {
+    return sizeof(MetricsBlock) + counts.capacity() * sizeof(int64_t) + tnd_ve_est.capacity() * sizeof(double);
 }
 
 DatabaseHandler::DatabaseHandler(const Storyteller* storyteller) 
     : n_transaction_attempts(10),
-      ms_delay_between_attempts(1000),
       owner(storyteller),
       tome(storyteller->get_tome()) {
     database_path = tome->get_path("database");
+    connection = DatabaseConnection::for_path(database_path);
+    writer = storyteller->get_database_writer();
 }
 
 DatabaseHandler::~DatabaseHandler() {}
 
+/**
+ * @details The caller holds the connection's mutex and a transaction.
+ */
+void DatabaseHandler::update_job(DatabaseConnection* connection, const ParticleJob& job) {
+    auto& query = connection->statement(
+        "UPDATE job SET status=?, attempts=?, completions=?, start_time=?, duration=? WHERE serial=?");
+    query.bind(1, job.status);
+    query.bind(2, (long long) job.attempts);
+    query.bind(3, (long long) job.completions);
+    query.bind(4, job.start_time);
+    query.bind(5, job.duration);
+    query.bind(6, (long long) job.serial);
+    query.exec();
+}
+
 void DatabaseHandler::read_job(unsigned int serial) {
     simulation_job = ParticleJob(serial);
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READONLY);
-            SQLite::Statement query(db, "SELECT * FROM job WHERE serial = ?");
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& query = connection->statement("SELECT * FROM job WHERE serial = ?");
             query.bind(1, serial);
             while (query.executeStep()) {
                 simulation_job.attempts = (unsigned int) query.getColumn("attempts");
@@ -98,7 +139,7 @@ void DatabaseHandler::read_job(unsigned int serial) {
         } catch (std::exception& e) {
             std::cerr << "Read job " << serial << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
 
@@ -107,12 +148,20 @@ void DatabaseHandler::read_job(unsigned int serial) {
 void DatabaseHandler::start_job(unsigned int serial) {
     read_job(serial);
     simulation_job.start();
+    job_checkpoint.clear();
+
+    if (writer) {
+        writer->update_job(simulation_job);
+        std::cerr << ((owner->get_flag("verbose")) ? "Start job queued.\n" : "started... ");
+        return;
+    }
 
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             SQLite::Transaction transaction(db);
-            db.exec(simulation_job.update());
+            update_job(connection, simulation_job);
             transaction.commit();
 
             if (owner->get_flag("verbose")) {
@@ -124,20 +173,47 @@ void DatabaseHandler::start_job(unsigned int serial) {
         } catch (std::exception& e) {
             std::cerr << "Start job " << serial << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
 }
 
+/**
+ * @details A finished simulation hands its checkpoint over rather than removing
+ *          it, so that a job that is left running (eg, the process is killed
+ *          before the end is committed) can still be resumed.
+ */
+void DatabaseHandler::set_job_checkpoint(const std::filesystem::path& path) { job_checkpoint = path; }
+
+/**
+ * @details The job's checkpoint (see set_job_checkpoint) is removed once the
+ *          job's end is committed. A #writer does so for the jobs whose metrics it
+ *          was handed, which are the only ones a simulation hands a checkpoint.
+ */
 void DatabaseHandler::end_job(unsigned int serial) {
     simulation_job.end();
 
+    // queued together with the job's metrics, so it is never committed without them
+    if (writer) {
+        if (job_metrics) {
+            writer->end_job(std::move(job_metrics.value()), simulation_job, job_checkpoint);
+            job_metrics.reset();
+        } else {
+            writer->update_job(simulation_job);
+        }
+        job_checkpoint.clear();
+        std::cerr << ((owner->get_flag("verbose")) ? "End job queued.\n" : "job end\n");
+        return;
+    }
+
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             SQLite::Transaction transaction(db);
-            db.exec(simulation_job.update());
+            update_job(connection, simulation_job);
             transaction.commit();
+            if (not job_checkpoint.empty()) { std::filesystem::remove(job_checkpoint); }
 
             if (owner->get_flag("verbose")) {
                 std::cerr << "End job " << serial << " succeeded." << '\n';
@@ -148,18 +224,20 @@ void DatabaseHandler::end_job(unsigned int serial) {
         } catch (std::exception& e) {
             std::cerr << "End job " << serial << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
+    job_checkpoint.clear();
 }
 
 void DatabaseHandler::end_jobs(std::vector<ParticleJob>& jobs) {
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             SQLite::Transaction transaction(db);
             for (auto& job : jobs) {
-                db.exec(job.update());
+                update_job(connection, job);
             }
             transaction.commit();
 
@@ -172,30 +250,31 @@ void DatabaseHandler::end_jobs(std::vector<ParticleJob>& jobs) {
         } catch (std::exception& e) {
             std::cerr << "End jobs failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
 }
 
-std::map<std::string, double> DatabaseHandler::read_parameters(unsigned int serial, const std::vector<std::string>& pars) {
-    std::map<std::string, double> ret;
+ParameterSet DatabaseHandler::read_parameters(unsigned int serial, const ParameterSchema* schema) {
+    ParameterSet ret(schema);
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
-        ret.clear();
+        ret = ParameterSet(schema);
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READONLY);
-            SQLite::Statement query(db, "SELECT * FROM par WHERE serial = ?");
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& query = connection->statement("SELECT * FROM par WHERE serial = ?");
             query.bind(1, serial);
             while (query.executeStep()) {
-                for (auto& nickname : pars) {
-                    ret[nickname] = query.getColumn(nickname.c_str());
+                for (size_t slot = 0; slot < schema->size(); ++slot) {
+                    if (not schema->is_declared(slot)) { continue; }
+                    ret[slot] = query.getColumn(schema->get_nickname(slot).c_str());
                 }
             }
 
             if (owner->get_flag("verbose")) {
                 std::cerr << "Read attempt " << i << " succeeded." << '\n';
                 if (owner->get_flag("very_verbose")) {
-                    for (const auto& [k,v] : ret) {
-                        std::cerr << k << ": " << v << '\n';
+                    for (size_t slot = 0; slot < schema->size(); ++slot) {
+                        std::cerr << schema->get_nickname(slot) << ": " << ret[slot] << '\n';
                     }
                 }
             } else {
@@ -205,7 +284,7 @@ std::map<std::string, double> DatabaseHandler::read_parameters(unsigned int seri
         } catch (std::exception& e) {
             std::cerr << "Read attempt " << i << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
     return ret;
@@ -213,21 +292,23 @@ std::map<std::string, double> DatabaseHandler::read_parameters(unsigned int seri
 
 
 
-std::vector<std::map<std::string, double>> DatabaseHandler::read_batch_parameters(unsigned int serial_start, unsigned int serial_end, const std::vector<std::string>& pars) {
-    std::vector<std::map<std::string, double>> ret((serial_end - serial_start) + 1);
+std::vector<ParameterSet> DatabaseHandler::read_batch_parameters(unsigned int serial_start, unsigned int serial_end, const ParameterSchema* schema) {
+    std::vector<ParameterSet> ret((serial_end - serial_start) + 1, ParameterSet(schema));
     size_t index = 0;
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
-        ret = std::vector<std::map<std::string, double>>((serial_end - serial_start) + 1);
+        ret = std::vector<ParameterSet>((serial_end - serial_start) + 1, ParameterSet(schema));
         index = 0;
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READONLY);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             SQLite::Transaction transaction(db);
-            SQLite::Statement query(db, "SELECT * FROM par WHERE serial >= ? AND serial <= ?");
+            auto& query = connection->statement("SELECT * FROM par WHERE serial >= ? AND serial <= ?");
             query.bind(1, serial_start);
             query.bind(2, serial_end);
             while (query.executeStep()) {
-                for (auto& nickname : pars) {
-                    ret[index][nickname] = query.getColumn(nickname.c_str());
+                for (size_t slot = 0; slot < schema->size(); ++slot) {
+                    if (not schema->is_declared(slot)) { continue; }
+                    ret[index][slot] = query.getColumn(schema->get_nickname(slot).c_str());
                 }
                 index++;
             }
@@ -245,94 +326,107 @@ std::vector<std::map<std::string, double>> DatabaseHandler::read_batch_parameter
         } catch (std::exception& e) {
             std::cerr << "Read attempt " << i << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
     return ret;
 }
 
-std::vector<std::string> DatabaseHandler::prepare_insert_sql(const Ledger* ledger, const Parameters* par) const {
-    size_t n_rows = par->get("sim_duration");
-    std::vector<std::string> inserts(n_rows);
-    std::string tmp_col_order = "(serial,time,c_vax_flu_inf,c_vax_nonflu_inf,c_unvax_flu_inf,c_unvax_nonflu_inf,c_vax_flu_mai,c_vax_nonflu_mai,c_unvax_flu_mai,c_unvax_nonflu_mai,tnd_ve_est)";
-    std::stringstream sql;
-    for (size_t t = 0; t < n_rows; ++t) {
-        sql << "INSERT INTO met "
-            << tmp_col_order
-            << " VALUES ("
-            << par->simulation_serial << ","
-            << t << ","
-            << ledger->get_cumul_infs(VACCINATED, INFLUENZA, t) << ","
-            << ledger->get_cumul_infs(VACCINATED, NON_INFLUENZA, t) << ","
-            << ledger->get_cumul_infs(UNVACCINATED, INFLUENZA, t) << ","
-            << ledger->get_cumul_infs(UNVACCINATED, NON_INFLUENZA, t) << ","
-            << ledger->get_cumul_mais(VACCINATED, INFLUENZA, t) << ","
-            << ledger->get_cumul_mais(VACCINATED, NON_INFLUENZA, t) << ","
-            << ledger->get_cumul_mais(UNVACCINATED, INFLUENZA, t) << ","
-            << ledger->get_cumul_mais(UNVACCINATED, NON_INFLUENZA, t) << ","
-            << ledger->get_tnd_ve_est(t) << ");";
-
-        inserts[t] = sql.str();
-        sql.str(std::string());
+/**
+ * @details One row of placeholders for every day, eg, for two days
+ *          INSERT INTO met (serial,...,tnd_ve_est) VALUES (?,...,?),(?,...,?)
+ *          Each row binds 11 values, so MET_ROWS_PER_INSERT rows stay below
+ *          SQLite's default limit of 999 host parameters per statement.
+ */
+std::string DatabaseHandler::metrics_insert_sql(size_t n_rows) {
+    const std::string row = "(?,?,?,?,?,?,?,?,?,?,?)";
+    std::string sql = "INSERT INTO met "
+                      "(serial,time,c_vax_flu_inf,c_vax_nonflu_inf,c_unvax_flu_inf,c_unvax_nonflu_inf,c_vax_flu_mai,c_vax_nonflu_mai,c_unvax_flu_mai,c_unvax_nonflu_mai,tnd_ve_est)"
+                      " VALUES ";
+    sql.reserve(sql.size() + n_rows * (row.size() + 1));
+    for (size_t r = 0; r < n_rows; ++r) {
+        if (r > 0) sql += ',';
+        sql += row;
     }
-    return inserts;
+    return sql;
 }
 
-void DatabaseHandler::write_metrics(const Ledger* ledger, const Parameters* par) {
-    std::vector<std::string> inserts = prepare_insert_sql(ledger, par);
-    if (simulation_job.completions > 0) clear_metrics(par->simulation_serial);
-
-    for (size_t i = 0; i < n_transaction_attempts; ++i) {
-        try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
-            SQLite::Transaction transaction(db);
-            for (auto& sql : inserts) {
-                SQLite::Statement query(db, sql);
-                query.exec();
-                query.reset();
-            }
-            transaction.commit();
+/**
+ * @details Binds the block's values directly (no text formatting) to multi-row
+ *          inserts of MET_ROWS_PER_INSERT days, plus one shorter insert for the
+ *          remaining days. Both statements are prepared once per connection. The
+ *          caller holds the connection's mutex and a transaction, so replacing
+ *          earlier metrics of the serial is atomic.
+ */
+void DatabaseHandler::insert_metrics(DatabaseConnection* connection, const MetricsBlock& metrics) {
+    if (metrics.replace) {
+        auto& clear = connection->statement("DELETE FROM met WHERE serial=?");
+        clear.bind(1, (int64_t) metrics.serial);
+        clear.exec();
+    }
 
-            if (owner->get_flag("verbose")) {
-                std::cerr << "Write attempt " << i << " succeeded." << '\n';
-            } else {
-                std::cerr << "mets written... ";
+    const size_t n_days = metrics.n_days();
+    const std::string full_insert_sql = metrics_insert_sql(MET_ROWS_PER_INSERT);
+    size_t t = 0;
+    while (t < n_days) {
+        const size_t n_rows = std::min(MET_ROWS_PER_INSERT, n_days - t);
+        auto& insert = connection->statement((n_rows == MET_ROWS_PER_INSERT) ? full_insert_sql : metrics_insert_sql(n_rows));
+
+        int col = 1;
+        for (const size_t last = t + n_rows; t < last; ++t) {
+            insert.bind(col++, (int64_t) metrics.serial);
+            insert.bind(col++, (int64_t) t);
+            for (size_t c = 0; c < MetricsBlock::NUM_COUNTS; ++c) {
+                insert.bind(col++, metrics.counts[t * MetricsBlock::NUM_COUNTS + c]);
             }
-            break;
-        } catch (std::exception& e) {
-            std::cerr << "Write attempt " << i << " failed:" << '\n';
-            std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            insert.bind(col++, metrics.tnd_ve_est[t]);
         }
+        insert.exec();
     }
 }
 
-void DatabaseHandler::clear_metrics(unsigned int serial) {
+/**
+ * @details With a #writer the metrics are only copied, and queued by end_job;
+ *          they are committed later, together with those of other simulations.
+ */
+void DatabaseHandler::write_metrics(const Ledger* ledger, const Parameters* par) {
+    MetricsBlock metrics(simulation_job.serial, ledger, par->get(SIM_DURATION));
+    // an earlier attempt may have written metrics without marking the job done
+    metrics.replace = (simulation_job.attempts > 1) or (simulation_job.completions > 0);
+
+    if (writer) {
+        job_metrics = std::move(metrics);
+        std::cerr << ((owner->get_flag("verbose")) ? "Write queued.\n" : "mets queued... ");
+        return;
+    }
+
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             SQLite::Transaction transaction(db);
-            SQLite::Statement query(db, "DELETE FROM met WHERE serial=?");
-            query.bind(1, serial);
-            query.exec();
-            query.reset();
+            insert_metrics(connection, metrics);
             transaction.commit();
 
             if (owner->get_flag("verbose")) {
-                std::cerr << "Clear attempt " << serial << " succeeded." << '\n';
+                std::cerr << "Write attempt " << i << " succeeded." << '\n';
+            } else {
+                std::cerr << "mets written... ";
             }
             break;
         } catch (std::exception& e) {
-            std::cerr << "Clear attempt " << serial << " failed:" << '\n';
+            std::cerr << "Write attempt " << i << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
 }
 
 bool DatabaseHandler::database_exists() {
+    if (not std::filesystem::exists(database_path)) { return false; }
     try {
-        SQLite::Database db(database_path, SQLite::OPEN_READONLY);
+        std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+        auto& db = connection->database();
         return db.tableExists("par") and db.tableExists("met") and db.tableExists("job");
     } catch (std::exception& e) {
         std::cerr << "SQLite exception: " << e.what() << '\n';
@@ -341,14 +435,15 @@ bool DatabaseHandler::database_exists() {
 }
 
 bool DatabaseHandler::table_exists(std::string table) {
-    SQLite::Database db(database_path, SQLite::OPEN_READONLY);
-    return db.tableExists(table);
+    std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+    return connection->database().tableExists(table);
 }
 
 void DatabaseHandler::drop_table_if_exists(std::string table) {
     for (size_t i = 0; i < n_transaction_attempts; ++i) {
         try {
-            SQLite::Database db(database_path, SQLite::OPEN_READWRITE);
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            auto& db = connection->database();
             auto sql = "DROP TABLE IF EXISTS " + table;
             SQLite::Transaction transaction(db);
             db.exec(sql);
@@ -361,7 +456,7 @@ void DatabaseHandler::drop_table_if_exists(std::string table) {
         } catch (std::exception& e) {
             std::cerr << "Drop attempt for " << table << " failed:" << '\n';
             std::cerr << "\tSQLite exception: " << e.what() << '\n';
-            std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
+            connection->backoff(i);
         }
     }
 }
@@ -377,7 +472,6 @@ void DatabaseHandler::import_metrics_from(std::string file_path) {
     } catch (std::exception& e) {
         std::cerr << "Import attempt for " << file_path << " failed:" << '\n';
         std::cerr << "\t" << e.what() << '\n';
-        std::this_thread::sleep_for(milliseconds(ms_delay_between_attempts));
     }
 }
 
@@ -469,6 +563,32 @@ int DatabaseHandler::init_database() {
         }
     }
 
+    // validate every distinct value once here, so simulations never call into Lua
+    const auto schema = tome->get_parameter_schema();
+    bool valid = true;
+    for (size_t slot = 0; slot < schema->size(); ++slot) {
+        if ((slot != SEED) and (not schema->is_declared(slot))) {
+            std::cerr << "ERROR: required parameter " << schema->get_nickname(slot) << " is not defined\n";
+            valid = false;
+        }
+    }
+    for (const auto& fullname : par_fullnames) {
+        const auto slot = schema->slot_of(fullname);
+        const auto& vals = (par_copy_who.count(fullname)) ? par_values.at(par_copy_who.at(fullname))
+                                                          : par_values.at(fullname);
+        for (const auto& v : vals) {
+            if (not tome->validate_parameter(slot, v)) {
+                std::cerr << "ERROR: " << fullname << " has invalid value = " << v << '\n';
+                valid = false;
+            }
+        }
+    }
+
+    if (not valid) {
+        std::cerr << "Database init failed: invalid parameter values" << '\n';
+        return -1;
+    }
+
     // calculate step param combinations or create empty single row if no step params exist
     std::vector<std::string> sql_par_col_order;
     vector2d<double> par_rows;
@@ -562,7 +682,8 @@ int DatabaseHandler::init_database() {
     }
 
     try {
-        SQLite::Database db(database_path, SQLite::OPEN_READWRITE|SQLite::OPEN_CREATE);
+        std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+        auto& db = connection->database(true);
         SQLite::Transaction transaction(db);
         for (size_t i = 0; i < sql.size(); ++i) {
             SQLite::Statement query(db, sql[i]);
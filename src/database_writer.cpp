@@ -0,0 +1,194 @@
+/**
+ * @file database_writer.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the DatabaseWriter that commits the metrics and job updates of
+ *        a batch's simulations to the experiment database on its own thread.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <storyteller/database_writer.hpp>
+#include <storyteller/database_connection.hpp>
+
+DatabaseWriter::DatabaseWriter(DatabaseConnection* connection, size_t group_size, double group_seconds,
+                               size_t max_megabytes, bool verbose)
+    : connection(connection),
+      group_size(std::max<size_t>(group_size, 1)),
+      group_interval(group_seconds),
+      max_bytes(max_megabytes << 20),
+      verbose(verbose),
+      n_queued_metrics(0),
+      pending_bytes(0),
+      n_waiting(0),
+      n_flushing(0),
+      n_failed_groups(0),
+      stopping(false) {
+    thread = std::thread(&DatabaseWriter::run, this);
+}
+
+/**
+ * @details Commits everything still queued before the thread exits.
+ */
+DatabaseWriter::~DatabaseWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_one();
+    thread.join();
+}
+
+void DatabaseWriter::update_job(const ParticleJob& job) { enqueue(job, sizeof(ParticleJob)); }
+
+/**
+ * @details The metrics and the update that marks the job done are queued as one
+ *          update, so they always end up in the same group.
+ */
+void DatabaseWriter::end_job(MetricsBlock metrics, const ParticleJob& job, std::filesystem::path checkpoint) {
+    const auto bytes = metrics.bytes() + sizeof(ParticleJob);
+    enqueue(JobResults{std::move(metrics), job, std::move(checkpoint)}, bytes);
+}
+
+/**
+ * @details Has the writer commit what is queued right away, and waits until
+ *          every update queued so far has been committed (or given up on).
+ */
+void DatabaseWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++n_flushing;
+    work_ready.notify_one();
+    space_ready.wait(lock, [&]() { return pending_bytes == 0; });
+    --n_flushing;
+}
+
+/**
+ * @return true Some group of updates was given up on, so its jobs were left
+ *         running without their metrics
+ */
+bool DatabaseWriter::failed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return n_failed_groups > 0;
+}
+
+/**
+ * @details Waits while the update would take the pending updates over budget,
+ *          unless nothing is pending (so an update larger than the budget is
+ *          still written, on its own). A waiting simulation has the writer
+ *          commit what is queued right away.
+ */
+void DatabaseWriter::enqueue(Update update, size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto fits = [&]() { return (pending_bytes == 0) or (pending_bytes + bytes <= max_bytes); };
+    if (not fits()) {
+        ++n_waiting;
+        work_ready.notify_one();
+        space_ready.wait(lock, fits);
+        --n_waiting;
+    }
+
+    if (queue.empty()) { oldest_time = std::chrono::steady_clock::now(); }
+    if (std::holds_alternative<JobResults>(update)) { ++n_queued_metrics; }
+    queue.push_back(std::move(update));
+    queue_bytes.push_back(bytes);
+    pending_bytes += bytes;
+
+    // the writer starts the group's #group_interval when its first update arrives
+    if ((queue.size() == 1) or (n_queued_metrics >= group_size)) { work_ready.notify_one(); }
+}
+
+/**
+ * @details Takes the whole queue as one group when it holds #group_size
+ *          simulations' metrics, when the oldest update has waited
+ *          #group_interval, or when a simulation is waiting for budget or a
+ *          flush or the destructor asks for it. Simulations keep queueing while
+ *          the group is committed; its bytes are only released once it is.
+ */
+void DatabaseWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_ready.wait(lock, [&]() { return stopping or not queue.empty(); });
+        if (queue.empty()) { break; }
+
+        const auto deadline = oldest_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(group_interval);
+        work_ready.wait_until(lock, deadline, [&]() {
+            return stopping or (n_waiting > 0) or (n_flushing > 0) or (n_queued_metrics >= group_size);
+        });
+
+        std::vector<Update> group(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+        size_t group_bytes = 0;
+        for (auto bytes : queue_bytes) { group_bytes += bytes; }
+        const size_t n_metrics = n_queued_metrics;
+        queue.clear();
+        queue_bytes.clear();
+        n_queued_metrics = 0;
+
+        lock.unlock();
+        const bool committed = commit(group, n_metrics);
+        if (committed) { remove_checkpoints(group); }
+        lock.lock();
+
+        if (not committed) { ++n_failed_groups; }
+        pending_bytes -= group_bytes;
+        space_ready.notify_all();
+    }
+}
+
+/**
+ * @details Retries the whole group, like DatabaseHandler's own transactions. A
+ *          group that still fails is dropped: none of its jobs were marked done
+ *          (a job's metrics and its end are always in the same group), so they
+ *          are simulated again when the batch is rerun.
+ *
+ * @return false The group could not be committed
+ */
+bool DatabaseWriter::commit(const std::vector<Update>& group, size_t n_metrics) {
+    for (size_t i = 0; i < N_TRANSACTION_ATTEMPTS; ++i) {
+        try {
+            std::lock_guard<std::recursive_mutex> lock(connection->get_mutex());
+            SQLite::Transaction transaction(connection->database());
+            for (const auto& update : group) {
+                if (auto results = std::get_if<JobResults>(&update)) {
+                    DatabaseHandler::insert_metrics(connection, results->metrics);
+                    DatabaseHandler::update_job(connection, results->job);
+                } else {
+                    DatabaseHandler::update_job(connection, std::get<ParticleJob>(update));
+                }
+            }
+            transaction.commit();
+
+            if (verbose) {
+                std::cerr << "Committed " << group.size() << " updates (" << n_metrics
+                          << " simulations' metrics) in one transaction." << '\n';
+            }
+            return true;
+        } catch (std::exception& e) {
+            std::cerr << "Group commit attempt " << i << " failed:" << '\n';
+            std::cerr << "\tSQLite exception: " << e.what() << '\n';
+            connection->backoff(i);
+        }
+    }
+    std::cerr << "ERROR: could not commit " << group.size() << " updates (" << n_metrics
+              << " simulations' metrics); none of their jobs were marked done\n";
+    return false;
+}
+
+/**
+ * @details Called once the group is committed; a checkpoint that cannot be
+ *          removed only costs disk space, since its job is done.
+ */
+void DatabaseWriter::remove_checkpoints(const std::vector<Update>& group) {
+    for (const auto& update : group) {
+        auto results = std::get_if<JobResults>(&update);
+        if (results and not results->checkpoint.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(results->checkpoint, ec);
+        }
+    }
+}
\ No newline at end of file
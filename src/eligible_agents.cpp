@@ -0,0 +1,99 @@
+/**
+ * @file eligible_agents.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the EligibleAgents class that tracks which agents of a
+ *        Community can currently be infected.
+ *
+ * @copyright TBD
+ */
+#include <iostream>
+
+#include <storyteller/eligible_agents.hpp>
+#include <storyteller/checkpoint.hpp>
+
+/**
+ * @details Every agent in [first, last) starts out eligible. The wheel has one
+ *          slot per day up to max_delay days ahead, so an agent can be parked for
+ *          at most max_delay days.
+ */
+EligibleAgents::EligibleAgents(size_t first_agent, size_t last_agent, size_t max_delay,
+                               std::pmr::memory_resource* resource)
+    : first(first_agent),
+      agents(resource),
+      position(resource),
+      wheel(resource) {
+    reset(first_agent, last_agent, max_delay);
+}
+
+/**
+ * @details Makes every agent in [first, last) eligible again and empties the
+ *          wheel, reusing the storage of the previous simulation.
+ */
+void EligibleAgents::reset(size_t first_agent, size_t last_agent, size_t max_delay) {
+    first = first_agent;
+    const size_t n = last_agent - first_agent;
+    agents.resize(n);
+    position.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        agents[i]   = first + i;
+        position[i] = i;
+    }
+
+    wheel.resize(max_delay + 1);
+    for (auto& slot : wheel) { slot.clear(); }
+}
+
+void EligibleAgents::remove(size_t agent) {
+    const size_t pos = position[agent - first];
+    if (pos == NOT_ELIGIBLE) { return; }
+
+    // fill the hole with the last eligible agent
+    const size_t moved = agents.back();
+    agents[pos] = moved;
+    position[moved - first] = pos;
+    agents.pop_back();
+    position[agent - first] = NOT_ELIGIBLE;
+}
+
+/**
+ * @details The caller must release() every day in order, so the slot that
+ *          release_time maps to is not reused before it is reached.
+ */
+void EligibleAgents::park(size_t agent, size_t release_time) {
+    remove(agent);
+    wheel[release_time % wheel.size()].push_back(agent);
+}
+
+void EligibleAgents::release(size_t time) {
+    auto& slot = wheel[time % wheel.size()];
+    for (auto agent : slot) { insert(agent); }
+    slot.clear();
+}
+
+void EligibleAgents::insert(size_t agent) {
+    if (position[agent - first] != NOT_ELIGIBLE) {
+        std::cerr << "ERROR: agent " << agent << " is already eligible\n";
+        exit(-1);
+    }
+    position[agent - first] = agents.size();
+    agents.push_back(agent);
+}
+
+void EligibleAgents::save_state(checkpoint::Writer& out) const {
+    out.write(first);
+    out.write(agents);
+    out.write(position);
+    out.write(wheel);
+}
+
+void EligibleAgents::load_state(checkpoint::Reader& in) {
+    size_t saved_first = 0;
+    in.read(saved_first);
+    if (saved_first != first) {
+        std::cerr << "ERROR: checkpointed eligible agents start at " << saved_first << " instead of " << first << '\n';
+        exit(-1);
+    }
+    in.read(agents);
+    in.read(position);
+    in.read(wheel);
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+/**
+ * @file ensemble.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Ensemble object that advances several realizations of the
+ *        same particle together in lockstep.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+#include <storyteller/ensemble.hpp>
+#include <storyteller/community.hpp>
+#include <storyteller/simulator.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/utility.hpp>
+#include <storyteller/transmission_kernel.hpp>
+#include <storyteller/checkpoint.hpp>
+
+Ensemble::Ensemble(const Parameters* parameters, const std::vector<Realization>& realizations, SimulationArena* arena)
+    : sim_time(0),
+      checkpoint_interval(0),
+      interrupted(false),
+      n_active(realizations.size()),
+      offsets(realizations.size()),
+      par(parameters) {
+    for (const auto& r : realizations) {
+        simulators.push_back(std::make_unique<Simulator>(par, r.db_handler, r.rng_handler, arena));
+        simulators.back()->set_serial(r.serial);
+    }
+}
+
+Ensemble::~Ensemble() {}
+
+void Ensemble::set_flags(std::map<std::string, bool> flags) {
+    for (auto& sim : simulators) { sim->set_flags(flags); }
+}
+
+void Ensemble::set_population_cache(PopulationCache* cache) {
+    for (auto& sim : simulators) { sim->set_population_cache(cache); }
+}
+
+void Ensemble::set_synthpop(const SynthpopFile* file) {
+    for (auto& sim : simulators) { sim->set_synthpop(file); }
+}
+
+void Ensemble::set_checkpoint_interval(size_t days) {
+    checkpoint_interval = days;
+    for (auto& sim : simulators) { sim->set_checkpoint_interval(days); }
+}
+
+/**
+ * @details Simulators beyond the first serials.size() are left as they are, so a
+ *          later reset with more realizations resets them in turn.
+ */
+void Ensemble::reset(const std::vector<size_t>& serials) {
+    sim_time    = 0;
+    interrupted = false;
+    n_active    = std::min(serials.size(), simulators.size());
+    for (size_t r = 0; r < n_active; ++r) {
+        simulators[r]->reset();
+        simulators[r]->set_serial(serials[r]);
+    }
+}
+
+void Ensemble::init() {
+    for (size_t r = 0; r < n_active; ++r) { simulators[r]->init(); }
+}
+
+/**
+ * @details The realizations advance in lockstep, so they only resume if every one
+ *          of them has a checkpoint for the same day. Otherwise (eg, the process
+ *          was killed while writing them) the ensemble starts over from day 0.
+ */
+bool Ensemble::resume() {
+    std::vector<std::optional<size_t>> times;
+    for (size_t r = 0; r < n_active; ++r) { times.push_back(simulators[r]->checkpoint_time()); }
+
+    const bool none = std::none_of(times.begin(), times.end(), [](const auto& t) { return t.has_value(); });
+    if (none) { return false; }
+
+    const bool same_day = std::all_of(times.begin(), times.end(), [&](const auto& t) { return t == times.front(); });
+    if (not same_day) {
+        std::cerr << "WARNING: ensemble checkpoints are incomplete, restarting from day 0\n";
+        return false;
+    }
+
+    for (size_t r = 0; r < n_active; ++r) { simulators[r]->resume(); }
+    sim_time = times.front().value();
+    return true;
+}
+
+void Ensemble::simulate() {
+    const size_t sim_duration = par->get(SIM_DURATION);
+    while (sim_time < sim_duration) {
+        tick();
+        ++sim_time;
+        if ((sim_time == sim_duration) or (checkpoint_interval == 0)) { continue; }
+
+        if (checkpoint::termination_requested()) {
+            save_checkpoints();
+            interrupted = true;
+            break;
+        }
+        if (sim_time % checkpoint_interval == 0) { save_checkpoints(); }
+    }
+    for (size_t r = 0; r < n_active; ++r) { simulators[r]->sim_time = sim_time; }
+}
+
+void Ensemble::save_checkpoints() {
+    for (size_t r = 0; r < n_active; ++r) {
+        simulators[r]->sim_time = sim_time;
+        simulators[r]->save_checkpoint();
+    }
+}
+
+bool Ensemble::was_interrupted() const { return interrupted; }
+
+/**
+ * @details Every realization samples and stages its exposures into its own slice
+ *          of the shared batch, with its own streams, then one kernel call decides
+ *          the outcomes of all of them before each realization records its own.
+ */
+void Ensemble::tick() {
+    size_t n_exposed = 0;
+    for (size_t r = 0; r < n_active; ++r) {
+        offsets[r] = n_exposed;
+        n_exposed += simulators[r]->community->sample_exposures(sim_time);
+    }
+
+    batch.resize(n_exposed);
+    for (size_t r = 0; r < n_active; ++r) {
+        auto community = simulators[r]->community.get();
+        community->stage_exposures(community->exposures, sim_time, community->rng->get_rng(INFECTION),
+                                   community->rng->get_rng(BEHAVIOR), batch, offsets[r]);
+    }
+
+    transmission_kernel::evaluate(batch.view());
+
+    for (size_t r = 0; r < n_active; ++r) {
+        simulators[r]->community->apply_outcomes(sim_time, batch.outcomes.data() + offsets[r]);
+    }
+}
+
+void Ensemble::results() {
+    for (size_t r = 0; r < n_active; ++r) { simulators[r]->results(); }
+}
+
+size_t Ensemble::size() const { return n_active; }
\ No newline at end of file
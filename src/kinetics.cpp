@@ -0,0 +1,100 @@
+/**
+ * @file kinetics.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Kinetics class that precomputes the waning of infection-
+ *        acquired immunity and vaccine protection for a single simulation.
+ *
+ * @copyright TBD
+ */
+#include <cmath>
+#include <vector>
+
+#include <storyteller/kinetics.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/utility.hpp>
+
+Kinetics::Kinetics(const Parameters* par) {
+    const size_t sim_length = par->get(SIM_DURATION);
+
+    gen_immunity[INFLUENZA]         = par->get(FLU_INF_GEN_IMMUNITY);
+    gen_immunity[NON_INFLUENZA]     = par->get(NONFLU_INF_GEN_IMMUNITY);
+    immunity_wanes[INFLUENZA]       = par->get(FLU_INF_IMMUNITY_WANES);
+    immunity_wanes[NON_INFLUENZA]   = par->get(NONFLU_INF_IMMUNITY_WANES);
+    refractory_len[INFLUENZA]       = par->get(FLU_INF_REFRACT_LEN);
+    refractory_len[NON_INFLUENZA]   = par->get(NONFLU_INF_REFRACT_LEN);
+    vax_effect_wanes[INFLUENZA]     = par->get(FLU_VAX_EFFECT_WANES);
+    vax_effect_wanes[NON_INFLUENZA] = par->get(NONFLU_VAX_EFFECT_WANES);
+    vax_waning_lag[INFLUENZA]       = par->get(FLU_VAX_EFFECT_LAG_TIL_WANING);
+    vax_waning_lag[NON_INFLUENZA]   = par->get(NONFLU_VAX_EFFECT_LAG_TIL_WANING);
+
+    const std::array<double, NUM_STRAIN_TYPES> immunity_half_life = {
+        par->get(NONFLU_INF_IMMUNITY_HALF_LIFE),
+        par->get(FLU_INF_IMMUNITY_HALF_LIFE)
+    };
+    const std::array<double, NUM_STRAIN_TYPES> vax_half_life = {
+        par->get(NONFLU_VAX_EFFECT_HALF_LIFE),
+        par->get(FLU_VAX_EFFECT_HALF_LIFE)
+    };
+
+    immunity_table = vector2d<double>(NUM_STRAIN_TYPES, std::vector<double>(sim_length, 1.0));
+    vaccine_table  = vector2d<double>(NUM_STRAIN_TYPES, std::vector<double>(sim_length, 1.0));
+
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        immunity_waning_rate[s] = util::exp_decay_rate_from_half_life(immunity_half_life[s]);
+        vax_waning_rate[s]      = util::exp_decay_rate_from_half_life(vax_half_life[s]);
+
+        // the closed-form expressions evaluate time - (event_time + lag), which is
+        // exactly d - lag only when the lag is a whole number of days; otherwise the
+        // rounding of event_time + lag depends on the event day, so those strains
+        // keep evaluating the closed forms
+        immunity_tabulated[s] = (std::floor(refractory_len[s]) == refractory_len[s]);
+        vaccine_tabulated[s]  = (std::floor(vax_waning_lag[s]) == vax_waning_lag[s]);
+
+        if (gen_immunity[s] and immunity_wanes[s] and immunity_tabulated[s]) {
+            for (size_t d = 0; d < sim_length; ++d) {
+                // waning starts after the refractory period; values during the refractory
+                // period are negative but unused since the agent cannot be infected then
+                const double time_since_refractory = d - refractory_len[s];
+                immunity_table[s][d] = 1 - util::exp_decay(immunity_waning_rate[s], time_since_refractory);
+            }
+        }
+
+        if (vax_effect_wanes[s] and vaccine_tabulated[s]) {
+            for (size_t d = 0; d < sim_length; ++d) {
+                const double time_since_lag = d - vax_waning_lag[s];
+                vaccine_table[s][d] = (time_since_lag < 0)
+                                          ? 1.0
+                                          : util::exp_decay(vax_waning_rate[s], time_since_lag);
+            }
+        }
+    }
+}
+
+Kinetics::~Kinetics() {}
+
+bool Kinetics::infection_generates_immunity(StrainType strain) const { return gen_immunity[strain]; }
+bool Kinetics::infection_immunity_wanes(StrainType strain) const { return immunity_wanes[strain]; }
+ImmunityMode Kinetics::immunity_mode(StrainType strain) const {
+    if (not gen_immunity[strain]) { return NO_IMMUNITY; }
+    return (immunity_wanes[strain]) ? WANING_IMMUNITY : PERMANENT_IMMUNITY;
+}
+double Kinetics::refractory_period(StrainType strain) const { return refractory_len[strain]; }
+bool Kinetics::vaccine_effect_wanes(StrainType strain) const { return vax_effect_wanes[strain]; }
+
+/**
+ * @details The expression Person evaluated before the tables, for a strain whose
+ *          refractory period is not a whole number of days.
+ */
+double Kinetics::closed_form_immunity(StrainType strain, size_t time, size_t infection_time) const {
+    const auto time_since_refractory = time - (infection_time + refractory_len[strain]);
+    return 1 - util::exp_decay(immunity_waning_rate[strain], time_since_refractory);
+}
+
+/**
+ * @details The expression Person evaluated before the tables, for a strain whose
+ *          waning lag is not a whole number of days.
+ */
+double Kinetics::closed_form_vaccine(StrainType strain, size_t time, size_t vaccination_time) const {
+    const auto time_since_lag = time - (vaccination_time + vax_waning_lag[strain]);
+    return (time_since_lag < 0) ? 1.0 : util::exp_decay(vax_waning_rate[strain], time_since_lag);
+}
\ No newline at end of file
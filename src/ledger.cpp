@@ -14,21 +14,22 @@
 #include <storyteller/ledger.hpp>
 #include <storyteller/person.hpp>
 #include <storyteller/tome.hpp>
+#include <storyteller/population.hpp>
+#include <storyteller/checkpoint.hpp>
 
-Ledger::Ledger(const Parameters* parameters) {
+Ledger::Ledger(const Parameters* parameters, std::pmr::memory_resource* resource)
+    : record_infections(false),
+      infections(resource),
+      inf_incidence(resource),
+      sympt_inf_incidence(resource),
+      mai_incidence(resource),
+      cumul_infs(resource),
+      cumul_sympt_infs(resource),
+      cumul_mais(resource),
+      tnd_ve_estimate(resource),
+      vax_incidence(resource) {
     par = parameters;
-    auto sim_duration = par->get("sim_duration");
-    inf_incidence       = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-    sympt_inf_incidence = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-    mai_incidence       = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-
-    cumul_infs       = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-    cumul_sympt_infs = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-    cumul_mais       = vector3d<size_t>(NUM_VACCINATION_STATUSES, vector2d<size_t>(NUM_STRAIN_TYPES, std::vector<size_t>(sim_duration, 0)));
-
-    tnd_ve_estimate = std::vector<double>(sim_duration, 0.0);
-
-    vax_incidence = std::vector<size_t>(sim_duration, 0);
+    reset();
 
     linelist_header = "inf_id,inf_time,inf_strain,inf_sympts,inf_care,p_id,vax_status,baseline_suscep,vax_effect";
     simvis_header = "time,pr_flu_exposure,pr_nonflu_exposure,vaxd_flu_infs,vaxd_flu_mais,vaxd_nonflu_infs,vaxd_nonflu_mais,unvaxd_flu_infs,unvaxd_flu_mais,unvaxd_nonflu_infs,unvaxd_nonflu_mais,tnd_ve_est";
@@ -36,36 +37,115 @@ Ledger::Ledger(const Parameters* parameters) {
 
 Ledger::~Ledger() {}
 
-vector3d<size_t> Ledger::get_inf_incidence() const { return inf_incidence; }
-vector3d<size_t> Ledger::get_sympt_inf_incidence() const { return sympt_inf_incidence; }
-vector3d<size_t> Ledger::get_mai_incidence() const { return mai_incidence; }
+/**
+ * @details Zeroes every tally for the current parameters' simulation duration and
+ *          forgets every recorded infection, reusing the existing storage.
+ */
+void Ledger::reset() {
+    size_t sim_duration = par->get(SIM_DURATION);
+    infections.clear();
+
+    // nested pmr vectors hand the outer vector's resource down to their elements
+    for (auto incidence : {&inf_incidence, &sympt_inf_incidence, &mai_incidence, &cumul_infs, &cumul_sympt_infs, &cumul_mais}) {
+        incidence->resize(NUM_VACCINATION_STATUSES);
+        for (auto& by_strain : *incidence) {
+            by_strain.resize(NUM_STRAIN_TYPES);
+            for (auto& by_time : by_strain) {
+                by_time.assign(sim_duration, 0);
+            }
+        }
+    }
+
+    tnd_ve_estimate.assign(sim_duration, 0.0);
+
+    vax_incidence.assign(sim_duration, 0);
+}
+
+const pmr_vector3d<size_t>& Ledger::get_inf_incidence() const { return inf_incidence; }
+const pmr_vector3d<size_t>& Ledger::get_sympt_inf_incidence() const { return sympt_inf_incidence; }
+const pmr_vector3d<size_t>& Ledger::get_mai_incidence() const { return mai_incidence; }
 
-vector3d<size_t> Ledger::get_cumul_infs() const { return cumul_infs;}
-vector3d<size_t> Ledger::get_cumul_sympt_infs() const { return cumul_sympt_infs;}
-vector3d<size_t> Ledger::get_cumul_mais() const { return cumul_mais;}
+const pmr_vector3d<size_t>& Ledger::get_cumul_infs() const { return cumul_infs;}
+const pmr_vector3d<size_t>& Ledger::get_cumul_sympt_infs() const { return cumul_sympt_infs;}
+const pmr_vector3d<size_t>& Ledger::get_cumul_mais() const { return cumul_mais;}
 
-std::vector<size_t> Ledger::get_vax_incidence() const { return vax_incidence; }
-std::vector<double> Ledger::get_tnd_ve_est() const { return tnd_ve_estimate; }
+const std::pmr::vector<size_t>& Ledger::get_vax_incidence() const { return vax_incidence; }
+const std::pmr::vector<double>& Ledger::get_tnd_ve_est() const { return tnd_ve_estimate; }
 
 size_t Ledger::get_cumul_infs(VaccinationStatus vaxd, StrainType strain, size_t time) const { return cumul_infs[vaxd][strain][time]; }
 size_t Ledger::get_cumul_sympt_infs(VaccinationStatus vaxd, StrainType strain, size_t time) const { return cumul_sympt_infs[vaxd][strain][time]; }
 size_t Ledger::get_cumul_mais(VaccinationStatus vaxd, StrainType strain, size_t time) const { return cumul_mais[vaxd][strain][time]; }
 double Ledger::get_tnd_ve_est(size_t time) const { return tnd_ve_estimate[time]; }
 
-void Ledger::log_infection(const Infection* i) {
-    auto vaxd   = i->get_infectee()->is_vaccinated();
-    auto time   = i->get_infection_time();
-    auto strain = i->get_strain();
-    auto sympts = i->get_symptoms();
-    auto mai    = i->get_sought_care();
+void Ledger::set_parameters(const Parameters* parameters) { par = parameters; }
+
+void Ledger::log_infection(const Infection& i) {
+    auto vaxd   = i.get_infectee().is_vaccinated();
+    auto time   = i.get_infection_time();
+    auto strain = i.get_strain();
+    auto sympts = i.get_symptoms();
+    auto mai    = i.get_sought_care();
 
-    infections.push_back(i);
+    if (record_infections) infections.push_back(i);
 
     inf_incidence[vaxd][strain][time]++;
     if (sympts == SYMPTOMATIC) sympt_inf_incidence[vaxd][strain][time]++;
     if (mai) mai_incidence[vaxd][strain][time]++;
 }
 
+void LedgerTally::log_infection(const Infection& i, bool record) {
+    auto vaxd   = i.get_infectee().is_vaccinated();
+    auto strain = i.get_strain();
+
+    infs[vaxd][strain]++;
+    if (i.get_symptoms() == SYMPTOMATIC) sympt_infs[vaxd][strain]++;
+    if (i.get_sought_care()) mais[vaxd][strain]++;
+    if (record) infections.push_back(i);
+}
+
+void LedgerTally::clear() {
+    infs       = {};
+    sympt_infs = {};
+    mais       = {};
+    infections.clear();
+}
+
+/**
+ * @details Adds the tally's counts to the given day and empties the tally so it
+ *          can be reused the next day. Tallies must be merged in chunk order so
+ *          the recorded infections are in the same order for any thread count.
+ */
+void Ledger::merge(LedgerTally& tally, size_t time) {
+    for (size_t v = 0; v < NUM_VACCINATION_STATUSES; ++v) {
+        for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+            inf_incidence[v][s][time]       += tally.infs[v][s];
+            sympt_inf_incidence[v][s][time] += tally.sympt_infs[v][s];
+            mai_incidence[v][s][time]       += tally.mais[v][s];
+        }
+    }
+    if (record_infections) {
+        infections.insert(infections.end(), tally.infections.begin(), tally.infections.end());
+    }
+    tally.clear();
+}
+
+bool Ledger::is_recording_infections() const { return record_infections; }
+
+void Ledger::set_record_infections(bool record) { record_infections = record; }
+
+/**
+ * @details Only available when infections are being recorded (ie, a linelist
+ *          was requested); the Population itself keeps just the per-strain
+ *          summary state needed by the simulation.
+ */
+std::vector<const Infection*> Ledger::get_infection_history(const Person& p) const {
+    std::vector<const Infection*> history;
+    for (const auto& inf : infections) {
+        if (inf.get_infectee().get_id() == p.get_id()) history.push_back(&inf);
+    }
+    return history;
+}
+
 size_t Ledger::total_infections(VaccinationStatus vaxd, StrainType strain) const {
     return std::accumulate(inf_incidence[vaxd][strain].begin(),
                                  inf_incidence[vaxd][strain].end(),
@@ -101,7 +181,7 @@ void Ledger::calculate_cumulatives() {
 }
 
 void Ledger::calculate_tnd_ve_est() {
-    for (size_t t = 0; t < par->get("sim_duration"); ++t) {
+    for (size_t t = 0; t < par->get(SIM_DURATION); ++t) {
         auto cumul_vax_flu_mais      = cumul_mais[VACCINATED][INFLUENZA][t];
         auto cumul_vax_nonflu_mais   = cumul_mais[VACCINATED][NON_INFLUENZA][t];
         auto cumul_unvax_flu_mais    = cumul_mais[UNVACCINATED][INFLUENZA][t];
@@ -120,18 +200,18 @@ void Ledger::generate_linelist_csv(std::string filepath) {
     std::ofstream file(filepath);
     file << linelist_header << '\n';
     for (size_t i = 0; i < infections.size(); ++i) {
-        auto inf = infections[i];
-        auto strain = inf->get_strain();
-        auto infectee = inf->get_infectee();
+        const auto& inf = infections[i];
+        auto strain = inf.get_strain();
+        auto infectee = inf.get_infectee();
         file << i << ','
-             << inf->get_infection_time() << ','
+             << inf.get_infection_time() << ','
              << strain << ','
-             << inf->get_symptoms() << ','
-             << inf->get_sought_care() << ','
-             << infectee->get_id() << ','
-             << infectee->is_vaccinated() << ','
-             << infectee->get_susceptibility(strain) << ','
-             << infectee->get_vaccine_protection(strain) << '\n';
+             << inf.get_symptoms() << ','
+             << inf.get_sought_care() << ','
+             << infectee.get_id() << ','
+             << infectee.is_vaccinated() << ','
+             << infectee.get_susceptibility(strain) << ','
+             << infectee.get_vaccine_protection(strain) << '\n';
     }
     file.close();
 }
@@ -140,7 +220,7 @@ void Ledger::generate_simvis_csv(std::string filepath) {
     if (filepath.empty()) filepath = par->tome->get_path("simvis");
     std::ofstream file(filepath);
     file << simvis_header << '\n';
-    for (size_t t = 0; t < par->get("sim_duration"); ++t) {
+    for (size_t t = 0; t < par->get(SIM_DURATION); ++t) {
         file << t << ','
              << par->strain_probs[t][INFLUENZA] << ','
              << par->strain_probs[t][NON_INFLUENZA] << ','
@@ -156,4 +236,50 @@ void Ledger::generate_simvis_csv(std::string filepath) {
 
     }
     file.close();
+}
+
+/**
+ * @details Cumulative counts and VE estimates are derived from the incidence
+ *          after the simulation, so only the incidence (and the recorded
+ *          infections, stored by agent index) is written.
+ */
+void Ledger::save_state(checkpoint::Writer& out) const {
+    out.write(inf_incidence);
+    out.write(sympt_inf_incidence);
+    out.write(mai_incidence);
+    out.write(vax_incidence);
+
+    out.write(infections.size());
+    for (const auto& i : infections) {
+        out.write(i.get_infectee().get_id());
+        out.write(i.get_strain());
+        out.write(i.get_infection_time());
+        out.write(i.get_symptoms());
+        out.write(i.get_sought_care());
+    }
+}
+
+void Ledger::load_state(checkpoint::Reader& in, Population* population) {
+    in.read(inf_incidence);
+    in.read(sympt_inf_incidence);
+    in.read(mai_incidence);
+    in.read(vax_incidence);
+
+    size_t n_infections = 0;
+    in.read(n_infections);
+    infections.clear();
+    infections.reserve(n_infections);
+    for (size_t n = 0; n < n_infections; ++n) {
+        size_t agent;
+        StrainType strain;
+        size_t time;
+        SymptomClass symptoms;
+        bool sought_care;
+        in.read(agent);
+        in.read(strain);
+        in.read(time);
+        in.read(symptoms);
+        in.read(sought_care);
+        infections.emplace_back((*population)[agent], strain, time, symptoms, sought_care);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * @file parameter_set.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the compiled parameter schema that assigns every parameter a
+ *        dense slot and the flat ParameterSet that stores values by slot.
+ *
+ * @copyright TBD
+ */
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <storyteller/parameter_set.hpp>
+
+ParameterSchema::ParameterSchema() {
+    for (size_t id = 0; id < NUM_BUILTIN_PARAMETERS; ++id) {
+        const std::string nickname = builtin_parameter_nicknames[id];
+        fullnames.push_back(nickname);
+        nicknames.push_back(nickname);
+        datatypes.push_back("double");
+        flags.push_back("");
+        declared.push_back(false);
+        slots[nickname] = id;
+    }
+
+    // the seed is not a user parameter but is always a column of the par table
+    datatypes[SEED] = "INT";
+    flags[SEED]     = "seed";
+    declared[SEED]  = true;
+}
+
+size_t ParameterSchema::declare(const std::string& fullname, const std::string& nickname,
+                                const std::string& datatype, const std::string& flag) {
+    size_t slot = size();
+    auto builtin = slots.find(nickname);
+    if (builtin != slots.end() and builtin->second < NUM_BUILTIN_PARAMETERS) {
+        slot = builtin->second;
+        if (declared[slot]) {
+            std::cerr << "ERROR: parameter " << nickname << " is declared more than once\n";
+            exit(-1);
+        }
+    } else if (slots.count(fullname) or slots.count(nickname)) {
+        std::cerr << "ERROR: parameter " << fullname << " (" << nickname << ") is declared more than once\n";
+        exit(-1);
+    } else {
+        fullnames.emplace_back();
+        nicknames.emplace_back();
+        datatypes.emplace_back();
+        flags.emplace_back();
+        declared.push_back(false);
+    }
+
+    fullnames[slot] = fullname;
+    nicknames[slot] = nickname;
+    datatypes[slot] = datatype;
+    flags[slot]     = flag;
+    declared[slot]  = true;
+
+    slots[fullname] = slot;
+    slots[nickname] = slot;
+    return slot;
+}
+
+size_t ParameterSchema::size() const { return nicknames.size(); }
+bool ParameterSchema::has(const std::string& name) const { return slots.count(name); }
+size_t ParameterSchema::slot_of(const std::string& name) const { return slots.at(name); }
+bool ParameterSchema::is_declared(size_t slot) const { return declared[slot]; }
+
+const std::string& ParameterSchema::get_fullname(size_t slot) const { return fullnames[slot]; }
+const std::string& ParameterSchema::get_nickname(size_t slot) const { return nicknames[slot]; }
+const std::string& ParameterSchema::get_datatype(size_t slot) const { return datatypes[slot]; }
+const std::string& ParameterSchema::get_flag(size_t slot) const { return flags[slot]; }
+
+ParameterSet::ParameterSet() : schema(nullptr) {}
+
+ParameterSet::ParameterSet(const ParameterSchema* parameter_schema)
+    : schema(parameter_schema),
+      values(parameter_schema->size(), std::numeric_limits<double>::infinity()) {}
+
+size_t ParameterSet::size() const { return values.size(); }
+const ParameterSchema* ParameterSet::get_schema() const { return schema; }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <cmath>
 
 #include <gsl/gsl_randist.h>
+#include <gsl/gsl_cdf.h>
 #include <sol/sol.hpp>
 
 #include <storyteller/parameters.hpp>
@@ -24,107 +25,116 @@
 #include <storyteller/utility.hpp>
 #include <storyteller/database_handler.hpp>
 #include <storyteller/tome.hpp>
-
-Parameter::Parameter(const std::string name, const sol::table& attributes)
-    : fullname(name),
-      nickname(attributes.get<std::string>("nickname")),
-      description(attributes.get<std::string>("description")),
-      flag(attributes.get<std::string>("flag")),
-      datatype(attributes.get<std::string>("datatype")),
-      _validate(attributes.get<sol::function>("validate")),
-      value(std::numeric_limits<double>::infinity()) {}
-
-Parameter::~Parameter() { _validate = {}; }
-
-inline std::string Parameter::get_fullname() const { return fullname; }
-inline std::string Parameter::get_nickname() const { return nickname; }
-inline double      Parameter::get_value()    const { return value; }
-inline bool        Parameter::validate()     const { return _validate(value); }
+#include <storyteller/kinetics.hpp>
 
 Parameters::Parameters(RngHandler* rngh, DatabaseHandler* dbh, const Tome* t)
-    : rng(rngh),
-      db(dbh),
+    : return_metrics(t->get_metric_names()),
       tome(t),
-      pars_to_read({"seed"}) {
+      schema(t->get_parameter_schema()),
+      values(t->get_parameter_schema()),
+      rng(rngh),
+      db(dbh) {
     database_path = tome->get_path("database");
-
-    return_metrics.clear();
-    for (auto& [key, el] : tome->get_config_metrics()) {
-        return_metrics.push_back(key);
-    }
-
-    sol::optional<sol::table> pars = tome->get_config_params().at("parameters").as<sol::table>();
-    if (pars) {
-        for (const auto& [key, obj] : pars.value()) {
-            auto fullname   = key.as<std::string>();
-            auto attributes = obj.as<sol::table>();
-            auto nickname   = attributes.get_or<std::string>("nickname", fullname);
-
-            pars_to_read.push_back(nickname);
-            insert(fullname, attributes);
-        }
-    }
 }
 
-void Parameters::slurp_params(std::map<std::string, double> pars_from_db) {
-    if (pars_to_read.size() == pars_from_db.size()) {
-        for (const auto& nickname : pars_to_read) {
-            if (nickname == "seed") {
-                rng->set_seed(pars_from_db.at("seed"));
-                pars_from_db.erase("seed");
-            } else {
-                auto fullname = lookup.at(nickname);
-                params.at(fullname)->value = pars_from_db.at(nickname);
-            }
-        }
+Parameters::~Parameters() {}
+
+void Parameters::slurp_params(const ParameterSet& pars_from_db) {
+    if ((pars_from_db.get_schema() == schema) and (pars_from_db.size() == values.size())) {
+        values = pars_from_db;
+        rng->set_seed(values[SEED]);
     } else {
         std::cerr << "ERROR: number of params read (" << pars_from_db.size()
-                  << ") does not match the number expected (" << pars_to_read.size() << ").\n";
+                  << ") does not match the number expected (" << values.size() << ").\n";
         exit(-1);
     }
 }
 
 void Parameters::read_parameters_for_serial(size_t serial) {
     simulation_serial = serial;
-    auto pars_from_db = db->read_parameters(serial, pars_to_read);
+    auto pars_from_db = db->read_parameters(serial, schema);
 
     slurp_params(pars_from_db);
 
     calc_strain_probs();
+    calc_kinetics();
 }
 
-void Parameters::read_parameters_from_batch(size_t serial, std::map<std::string, double> pars_from_db) {
+void Parameters::read_parameters_from_batch(size_t serial, const ParameterSet& pars_from_db) {
     simulation_serial = serial;
 
     slurp_params(pars_from_db);
 
     calc_strain_probs();
+    calc_kinetics();
 }
 
-bool Parameters::insert(const std::string key, const sol::table& attributes) {
-    auto nickname = attributes.get<std::string>("nickname");
-    lookup[key] = key;
-    lookup[nickname] = key;
-    auto ret = params.insert({key, std::make_unique<Parameter>(key, attributes)});
-    return ret.second;
-}
+/**
+ * @details Builds a parameter set from the values defined in the Tome's parameter
+ *          config rather than from the experiment database: constant parameters
+ *          use their value, step parameters use their first value, and copy
+ *          parameters use the value of the parameter they copy. Any parameter
+ *          (including the seed) can be overridden by full name or nickname.
+ *          Intended for benchmarks and tools that run without a database.
+ */
+void Parameters::read_default_parameters(const std::map<std::string, double>& overrides) {
+    simulation_serial = 0;
+    ParameterSet pars(schema);
+    pars[SEED] = 0;
+
+    std::map<size_t, std::string> copies;
+    const auto cfg_pars = tome->get_config_params().at("parameters").as<sol::table>();
+    for (const auto& [key, obj] : cfg_pars) {
+        const auto fullname = key.as<std::string>();
+        const auto p        = obj.as<sol::table>();
+        const auto flag     = p.get<std::string>("flag");
+        const auto slot     = schema->slot_of(fullname);
+
+        if (flag == "const") {
+            pars[slot] = p.get<double>("value");
+        } else if (flag == "step") {
+            auto defined_vals = p.get<sol::optional<std::vector<double>>>("values");
+            pars[slot] = (defined_vals) ? defined_vals.value().front() : p.get<double>("lower");
+        } else if (flag == "copy") {
+            copies[slot] = p.get<std::string>("who");
+        } else {
+            std::cerr << "ERROR: " << fullname << " has an unsupported flag (" << flag << ")\n";
+            exit(-1);
+        }
+    }
+
+    for (const auto& [slot, who] : copies) {
+        pars[slot] = pars[schema->slot_of(who)];
+    }
 
-double Parameters::get(std::string key) const {
-    auto fullname = lookup.at(key);
-    auto p = params.at(fullname).get();
-    return p->get_value();
+    for (const auto& [name, value] : overrides) {
+        if (not schema->has(name)) {
+            std::cerr << "ERROR: cannot override unknown parameter " << name << '\n';
+            exit(-1);
+        }
+        pars[schema->slot_of(name)] = value;
+    }
+
+    slurp_params(pars);
+
+    calc_strain_probs();
+    calc_kinetics();
 }
 
+double Parameters::get(const std::string& key) const { return values[schema->slot_of(key)]; }
+
+const ParameterSet& Parameters::get_values() const { return values; }
+
 void Parameters::calc_strain_probs() {
-    const auto sim_length = get("sim_duration");
+    const auto sim_length = get(SIM_DURATION);
     strain_probs = std::vector<std::vector<double>>(sim_length, std::vector<double>(NUM_STRAIN_TYPES + 1, 0.0));
 
-    const auto mean_pr_nonflu_exposure = get("pr_nonflu_exposure");
-    const auto mean_pr_flu_exposure    = get("pr_flu_exposure");
+    const auto mean_pr_nonflu_exposure = get(PR_NONFLU_EXPOSURE);
+    const auto mean_pr_flu_exposure    = get(PR_FLU_EXPOSURE);
 
-    const auto amplitude_mult = get("seasonal_amplitude_mult");
-    const auto period         = (2 * constants::PI) / get("seasonal_period");
-    const auto shift          = get("seasonal_shift");
+    const auto amplitude_mult = get(SEASONAL_AMPLITUDE_MULT);
+    const auto period         = (2 * constants::PI) / get(SEASONAL_PERIOD);
+    const auto shift          = get(SEASONAL_SHIFT);
 
     for (size_t i = 0; i < sim_length; ++i) {
         const auto seasonal_forcing   = 1 + (amplitude_mult * std::cos(period * (i + shift)));
@@ -137,18 +147,24 @@ void Parameters::calc_strain_probs() {
     }
 }
 
-double Parameters::sample_discrete_susceptibility(const bool vaccinated, const StrainType strain) const {
+void Parameters::calc_kinetics() {
+    kinetics = std::make_unique<Kinetics>(this);
+}
+
+const Kinetics* Parameters::get_kinetics() const { return kinetics.get(); }
+
+void Parameters::sample_discrete_susceptibility(const bool vaccinated, const StrainType strain, gsl_rng* stream, double* out, size_t n) const {
     auto suscep_w_prior = -1.0;
     auto suscep_wo_prior = -1.0;
     switch (strain) {
         case NON_INFLUENZA: {
-            suscep_w_prior  = (vaccinated) ? get("vaxd_nonflu_suscep_mean")     : get("unvaxd_nonflu_suscep_mean");
-            suscep_wo_prior = (vaccinated) ? get("vaxd_nonflu_suscep_baseline") : get("unvaxd_nonflu_suscep_baseline");
+            suscep_w_prior  = (vaccinated) ? get(VAXD_NONFLU_SUSCEP_MEAN)     : get(UNVAXD_NONFLU_SUSCEP_MEAN);
+            suscep_wo_prior = (vaccinated) ? get(VAXD_NONFLU_SUSCEP_BASELINE) : get(UNVAXD_NONFLU_SUSCEP_BASELINE);
             break;
         }
         case INFLUENZA: {
-            suscep_w_prior  = (vaccinated) ? get("vaxd_flu_suscep_mean")     : get("unvaxd_flu_suscep_mean");
-            suscep_wo_prior = (vaccinated) ? get("vaxd_flu_suscep_baseline") : get("unvaxd_flu_suscep_baseline");
+            suscep_w_prior  = (vaccinated) ? get(VAXD_FLU_SUSCEP_MEAN)     : get(UNVAXD_FLU_SUSCEP_MEAN);
+            suscep_wo_prior = (vaccinated) ? get(VAXD_FLU_SUSCEP_BASELINE) : get(UNVAXD_FLU_SUSCEP_BASELINE);
             break;
         }
         default: {
@@ -162,26 +178,30 @@ double Parameters::sample_discrete_susceptibility(const bool vaccinated, const S
         exit(-1);
     }
 
-    const auto pr_prior_immunity = (vaccinated) ? get("pr_prior_imm_vaxd") : get("pr_prior_imm_unvaxd");
+    const auto pr_prior_immunity = (vaccinated) ? get(PR_PRIOR_IMM_VAXD) : get(PR_PRIOR_IMM_UNVAXD);
     if (pr_prior_immunity == 0.0) {
-        return suscep_wo_prior;
+        std::fill(out, out + n, suscep_wo_prior);
     } else {
-        return (rng->draw_from_rng(INFECTION) < pr_prior_immunity) ? suscep_w_prior : suscep_wo_prior;
+        // draw the prior-immunity uniforms in place and threshold them
+        RngHandler::fill_uniform(stream, out, n);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = (out[i] < pr_prior_immunity) ? suscep_w_prior : suscep_wo_prior;
+        }
     }
 }
 
-double Parameters::sample_continuous_susceptibility(const bool vaccinated, const StrainType strain) const {
+void Parameters::sample_continuous_susceptibility(const bool vaccinated, const StrainType strain, gsl_rng* stream, double* out, size_t n) const {
     auto mean = -1.0;
     auto sd = -1.0;
     switch (strain) {
         case NON_INFLUENZA: {
-            mean = (vaccinated) ? get("vaxd_nonflu_suscep_mean") : get("unvaxd_nonflu_suscep_mean");
-            sd  = (vaccinated) ? get("vaxd_nonflu_suscep_sd")  : get("unvaxd_nonflu_suscep_sd");
+            mean = (vaccinated) ? get(VAXD_NONFLU_SUSCEP_MEAN) : get(UNVAXD_NONFLU_SUSCEP_MEAN);
+            sd  = (vaccinated) ? get(VAXD_NONFLU_SUSCEP_SD)  : get(UNVAXD_NONFLU_SUSCEP_SD);
             break;
         }
         case INFLUENZA: {
-            mean = (vaccinated) ? get("vaxd_flu_suscep_mean") : get("unvaxd_flu_suscep_mean");
-            sd  = (vaccinated) ? get("vaxd_flu_suscep_sd")  : get("unvaxd_flu_suscep_sd");
+            mean = (vaccinated) ? get(VAXD_FLU_SUSCEP_MEAN) : get(UNVAXD_FLU_SUSCEP_MEAN);
+            sd  = (vaccinated) ? get(VAXD_FLU_SUSCEP_SD)  : get(UNVAXD_FLU_SUSCEP_SD);
             break;
         }
         default: {
@@ -195,43 +215,45 @@ double Parameters::sample_continuous_susceptibility(const bool vaccinated, const
         exit(-1);
     }
 
-    // gsl gaussian is always centered at 0 and must be shifted to the specified mean
-    // https://www.gnu.org/software/gsl/doc/html/randist.html#the-gaussian-distribution
-    auto log_odds = util::logit(mean) + gsl_ran_gaussian(rng->get_rng(INFECTION), sd);
-    return util::logistic(log_odds);
+    // gaussian draws are centered at 0 and must be shifted to the specified mean
+    RngHandler::fill_gaussian(stream, out, n, sd);
+    const auto mean_log_odds = util::logit(mean);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = util::logistic(mean_log_odds + out[i]);
+    }
 }
 
-std::vector<double> Parameters::sample_susceptibility(const Person* p) const {
-    std::vector<double> susceps(NUM_STRAIN_TYPES, 1.0);
-
-    auto is_vaxd = p->is_vaccinated();
-
-    auto contin_flu_suscep = (is_vaxd)
-                                 ? get("vaxd_flu_suscep_is_contin")
-                                 : get("unvaxd_flu_suscep_is_contin");
-    susceps[INFLUENZA] = (contin_flu_suscep == 0.0)
-                             ? sample_discrete_susceptibility(is_vaxd, INFLUENZA)
-                             : sample_continuous_susceptibility(is_vaxd, INFLUENZA);
+/**
+ * @details Fills out with the susceptibility to strain of n agents that share the
+ *          given vaccination status, drawing all of the values in one batch.
+ */
+void Parameters::sample_susceptibility(VaccinationStatus vaxd, StrainType strain, gsl_rng* stream, double* out, size_t n) const {
+    if (n == 0) { return; }
+    const bool is_vaxd = (vaxd == VACCINATED);
 
-    auto contin_nonflu_suscep = (is_vaxd)
-                                    ? get("vaxd_nonflu_suscep_is_contin")
-                                    : get("unvaxd_nonflu_suscep_is_contin");
-    susceps[NON_INFLUENZA] = (contin_nonflu_suscep == 0.0)
-                                 ? sample_discrete_susceptibility(is_vaxd, NON_INFLUENZA)
-                                 : sample_continuous_susceptibility(is_vaxd, NON_INFLUENZA);
+    double contin_suscep = 0.0;
+    if (strain == INFLUENZA) {
+        contin_suscep = (is_vaxd) ? get(VAXD_FLU_SUSCEP_IS_CONTIN) : get(UNVAXD_FLU_SUSCEP_IS_CONTIN);
+    } else {
+        contin_suscep = (is_vaxd) ? get(VAXD_NONFLU_SUSCEP_IS_CONTIN) : get(UNVAXD_NONFLU_SUSCEP_IS_CONTIN);
+    }
 
-    return susceps;
+    if (contin_suscep == 0.0) {
+        sample_discrete_susceptibility(is_vaxd, strain, stream, out, n);
+    } else {
+        sample_continuous_susceptibility(is_vaxd, strain, stream, out, n);
+    }
 }
 
-double Parameters::sample_discrete_vaccine_effect(const StrainType strain) const {
+void Parameters::sample_discrete_vaccine_effect(const StrainType strain, gsl_rng* /*stream*/, double* out, size_t n) const {
     auto mean = -1.0;
     switch (strain) {
         case NON_INFLUENZA: {
-            mean = get("nonflu_vax_effect_mean");
+            mean = get(NONFLU_VAX_EFFECT_MEAN);
             break;
         }
         case INFLUENZA: {
-            mean = mean = get("flu_vax_effect_mean");
+            mean = mean = get(FLU_VAX_EFFECT_MEAN);
             break;
         }
         default: {
@@ -245,21 +267,21 @@ double Parameters::sample_discrete_vaccine_effect(const StrainType strain) const
         exit(-1);
     }
 
-    return mean;
+    std::fill(out, out + n, mean);
 }
 
-double Parameters::sample_continuous_vaccine_effect(const StrainType strain) const {
+void Parameters::sample_continuous_vaccine_effect(const StrainType strain, gsl_rng* stream, double* out, size_t n) const {
     auto mean = -1.0;
     auto var = -1.0;
     switch (strain) {
         case NON_INFLUENZA: {
-            mean = get("nonflu_vax_effect_mean");
-            var  = get("nonflu_vax_effect_var");
+            mean = get(NONFLU_VAX_EFFECT_MEAN);
+            var  = get(NONFLU_VAX_EFFECT_VAR);
             break;
         }
         case INFLUENZA: {
-            mean = get("flu_vax_effect_mean");
-            var  = get("flu_vax_effect_var");
+            mean = get(FLU_VAX_EFFECT_MEAN);
+            var  = get(FLU_VAX_EFFECT_VAR);
             break;
         }
         default: {
@@ -275,23 +297,76 @@ double Parameters::sample_continuous_vaccine_effect(const StrainType strain) con
 
     const auto a = util::beta_a_from_mean_var(mean, var);
     const auto b = util::beta_b_from_mean_var(mean, var);
-    return gsl_ran_beta(rng->get_rng(VACCINATION), a, b);
+    RngHandler::fill_beta(stream, out, n, a, b);
 }
 
-std::vector<double> Parameters::sample_vaccine_effect() const {
-    std::vector<double> vax_effects(NUM_STRAIN_TYPES, 0.0);
+/**
+ * @details Fills out with the vaccine protection against strain for n vaccinated
+ *          agents, drawing all of the values in one batch.
+ */
+void Parameters::sample_vaccine_effect(StrainType strain, gsl_rng* stream, double* out, size_t n) const {
+    if (n == 0) { return; }
+    const auto contin_vax = (strain == INFLUENZA) ? get(FLU_VAX_EFFECT_IS_CONTIN) : get(NONFLU_VAX_EFFECT_IS_CONTIN);
+    if (contin_vax == 0.0) {
+        sample_discrete_vaccine_effect(strain, stream, out, n);
+    } else {
+        sample_continuous_vaccine_effect(strain, stream, out, n);
+    }
+}
 
-    const auto contin_flu_vax = get("flu_vax_effect_is_contin");
-    vax_effects[INFLUENZA] = (contin_flu_vax == 0.0)
-                                 ? sample_discrete_vaccine_effect(INFLUENZA)
-                                 : sample_continuous_vaccine_effect(INFLUENZA);
+/**
+ * @details Maps uniforms in (0, 1) (eg, keyed draws in the common random numbers
+ *          mode) to susceptibilities through the quantile function of the same
+ *          distribution sample_susceptibility draws from. Each output is monotone
+ *          in its uniform, so a given draw gives nearby susceptibilities for nearby
+ *          parameter values.
+ */
+void Parameters::susceptibility_from_uniform(VaccinationStatus vaxd, StrainType strain, const double* u, double* out,
+                                             size_t n) const {
+    const bool is_vaxd = (vaxd == VACCINATED);
+    const bool is_flu  = (strain == INFLUENZA);
+
+    const auto is_contin = (is_flu) ? get((is_vaxd) ? VAXD_FLU_SUSCEP_IS_CONTIN : UNVAXD_FLU_SUSCEP_IS_CONTIN)
+                                    : get((is_vaxd) ? VAXD_NONFLU_SUSCEP_IS_CONTIN : UNVAXD_NONFLU_SUSCEP_IS_CONTIN);
+    const auto mean      = (is_flu) ? get((is_vaxd) ? VAXD_FLU_SUSCEP_MEAN : UNVAXD_FLU_SUSCEP_MEAN)
+                                    : get((is_vaxd) ? VAXD_NONFLU_SUSCEP_MEAN : UNVAXD_NONFLU_SUSCEP_MEAN);
+
+    if (is_contin == 0.0) {
+        const auto baseline = (is_flu) ? get((is_vaxd) ? VAXD_FLU_SUSCEP_BASELINE : UNVAXD_FLU_SUSCEP_BASELINE)
+                                       : get((is_vaxd) ? VAXD_NONFLU_SUSCEP_BASELINE : UNVAXD_NONFLU_SUSCEP_BASELINE);
+        const auto pr_prior_immunity = (is_vaxd) ? get(PR_PRIOR_IMM_VAXD) : get(PR_PRIOR_IMM_UNVAXD);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = (u[i] < pr_prior_immunity) ? mean : baseline;
+        }
+    } else {
+        const auto sd = (is_flu) ? get((is_vaxd) ? VAXD_FLU_SUSCEP_SD : UNVAXD_FLU_SUSCEP_SD)
+                                 : get((is_vaxd) ? VAXD_NONFLU_SUSCEP_SD : UNVAXD_NONFLU_SUSCEP_SD);
+        const auto mean_log_odds = util::logit(mean);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = util::logistic(mean_log_odds + gsl_cdf_gaussian_Pinv(u[i], sd));
+        }
+    }
+}
 
-    const auto contin_nonflu_vax = get("nonflu_vax_effect_is_contin");
-    vax_effects[NON_INFLUENZA] = (contin_nonflu_vax == 0.0)
-                                     ? sample_discrete_vaccine_effect(NON_INFLUENZA)
-                                     : sample_continuous_vaccine_effect(NON_INFLUENZA);
+/**
+ * @details Maps uniforms in (0, 1) to vaccine protection through the quantile
+ *          function of the distribution sample_vaccine_effect draws from.
+ */
+void Parameters::vaccine_effect_from_uniform(StrainType strain, const double* u, double* out, size_t n) const {
+    const bool is_flu    = (strain == INFLUENZA);
+    const auto is_contin = get((is_flu) ? FLU_VAX_EFFECT_IS_CONTIN : NONFLU_VAX_EFFECT_IS_CONTIN);
+    const auto mean      = get((is_flu) ? FLU_VAX_EFFECT_MEAN : NONFLU_VAX_EFFECT_MEAN);
 
-    return vax_effects;
+    if (is_contin == 0.0) {
+        std::fill(out, out + n, mean);
+    } else {
+        const auto var = get((is_flu) ? FLU_VAX_EFFECT_VAR : NONFLU_VAX_EFFECT_VAR);
+        const auto a   = util::beta_a_from_mean_var(mean, var);
+        const auto b   = util::beta_b_from_mean_var(mean, var);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = gsl_cdf_beta_Pinv(u[i], a, b);
+        }
+    }
 }
 
 StrainType Parameters::sample_strain(const size_t time) const {
@@ -309,49 +384,87 @@ StrainType Parameters::sample_strain(const size_t time) const {
     return (StrainType) idx;
 }
 
-std::vector<StrainType> Parameters::daily_strain_sample(const size_t time) const {
-    // multinomial sample of strains weighted by their exposure probability
-    std::vector<StrainType> categories = {NON_INFLUENZA, INFLUENZA, NUM_STRAIN_TYPES};
-    std::vector<unsigned int> sample(categories.size(), 0);
-    gsl_ran_multinomial(
-        rng->get_rng(INFECTION),
-        categories.size(),
-        get("pop_size"),
-        strain_probs[time].data(),
-        sample.data()
-    );
+/**
+ * @details The number of candidates exposed to each strain is a multinomial sample
+ *          (the final category being "not exposed"), and the exposed strains are
+ *          assigned to a uniformly random subset of the candidates. This is the
+ *          same distribution as shuffling a candidate-sized vector of strains, but
+ *          only the exposed agents are ever touched, so the cost is O(exposures)
+ *          rather than O(candidates).
+ *
+ *          Because every agent's exposure is an independent categorical draw, the
+ *          candidates can be any subset of the population (eg, the agents in one
+ *          chunk, or only those that can currently be infected) without changing
+ *          the distribution of anyone's exposure.
+ *
+ *          Exposures are returned sorted by agent index so that infections are
+ *          attempted in population order. The candidates that have been picked
+ *          are marked in chosen (indexed by candidate position), a scratch buffer
+ *          owned by the caller that is all zeros before and after each call.
+ */
+void Parameters::sample_daily_exposures(const size_t time, const std::pmr::vector<size_t>& candidates, gsl_rng* r,
+                                        std::pmr::vector<Exposure>& exposures, std::pmr::vector<uint8_t>& chosen) const {
+    const size_t n_agents = candidates.size();
 
-    // convert multinomial sample into a randomly shuffled vector of strains
-    std::vector<StrainType> sampled_strains;
-    sampled_strains.reserve(get("pop_size"));
-    for (size_t i = 0; i < categories.size(); ++i) {
-        const auto strain = categories[i];
-        const auto count  = sample[i];
-        sampled_strains.insert(sampled_strains.begin(), count, strain);
+    // multinomial sample of strains weighted by their exposure probability
+    std::array<unsigned int, NUM_STRAIN_TYPES + 1> sample = {};
+    gsl_ran_multinomial(r, sample.size(), n_agents, strain_probs[time].data(), sample.data());
+
+    size_t num_exposed = 0;
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) { num_exposed += sample[s]; }
+
+    exposures.clear();
+    if (num_exposed == 0) { return; }
+    exposures.reserve(num_exposed);
+
+    // Floyd's algorithm draws num_exposed distinct agents with one draw each; the
+    // exposures hold candidate positions until the marks have been cleared
+    if (chosen.size() < n_agents) { chosen.resize(n_agents, 0); }
+    for (size_t j = n_agents - num_exposed; j < n_agents; ++j) {
+        const size_t t = gsl_rng_uniform_int(r, j + 1);
+        const size_t pick = (chosen[t]) ? j : t;
+        chosen[pick] = 1;
+        exposures.push_back({pick, NUM_STRAIN_TYPES});
+    }
+    for (auto& exposure : exposures) {
+        chosen[exposure.agent] = 0;
+        exposure.agent = candidates[exposure.agent];
+    }
+    std::sort(exposures.begin(), exposures.end(),
+              [](const Exposure& a, const Exposure& b) { return a.agent < b.agent; });
+
+    // randomly assign the sampled strains to the chosen agents (a Fisher-Yates
+    // shuffle in place, drawing exactly as gsl_ran_shuffle does)
+    size_t next = 0;
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        for (size_t n = 0; n < sample[s]; ++n) { exposures[next++].strain = (StrainType) s; }
+    }
+    for (size_t i = num_exposed - 1; i > 0; --i) {
+        const size_t j = gsl_rng_uniform_int(r, i + 1);
+        std::swap(exposures[i].strain, exposures[j].strain);
     }
-
-    gsl_ran_shuffle(
-        rng->get_rng(INFECTION),
-        sampled_strains.data(),
-        sampled_strains.size(),
-        sizeof(StrainType)
-    );
-
-    return sampled_strains;
 }
 
+/**
+ * @details Values read from the experiment database were validated against every
+ *          parameter's Lua `validate` function when the database was initialized,
+ *          so only the presence of every parameter (and that a value was read for
+ *          it) is checked here.
+ */
 bool Parameters::are_valid() const {
-    std::vector<bool> rets;
-    for (const auto& [fullname, p] : params) {
-        bool p_is_valid = p->validate();
-        if (not p_is_valid) {
-            rets.push_back(false);
-            std::cerr << "ERROR: " << fullname <<  " has invalid value = " << p->value << '\n';
-        } else {
-            rets.push_back(true);
+    bool valid = true;
+    for (size_t slot = 0; slot < values.size(); ++slot) {
+        if (slot == SEED) { continue; }
+
+        if (not schema->is_declared(slot)) {
+            valid = false;
+            std::cerr << "ERROR: required parameter " << schema->get_nickname(slot) << " is not defined\n";
+        } else if (std::isinf(values[slot])) {
+            valid = false;
+            std::cerr << "ERROR: " << schema->get_fullname(slot) << " has no value\n";
         }
     }
-    return std::all_of(rets.cbegin(), rets.cend(), [](bool v){ return (v == true);});
+    return valid;
 }
 
 // void Parameters::update_time_varying_parameters() {}
\ No newline at end of file
@@ -13,11 +13,13 @@
 #include <cmath>
 
 #include <storyteller/person.hpp>
+#include <storyteller/population.hpp>
 #include <storyteller/simulator.hpp>
 #include <storyteller/parameters.hpp>
+#include <storyteller/kinetics.hpp>
 #include <storyteller/utility.hpp>
 
-Infection::Infection(Person* p, StrainType strain, size_t t, SymptomClass sympt, bool care)
+Infection::Infection(Person p, StrainType strain, size_t t, SymptomClass sympt, bool care)
     : infectee(p),
       infection_strain(strain),
       infection_time(t),
@@ -26,155 +28,122 @@ Infection::Infection(Person* p, StrainType strain, size_t t, SymptomClass sympt,
 
 Infection::~Infection() {}
 
-Person* Infection::get_infectee() const { return infectee; }
+Person Infection::get_infectee() const { return infectee; }
 StrainType Infection::get_strain() const { return infection_strain; }
 size_t Infection::get_infection_time() const { return infection_time; }
 SymptomClass Infection::get_symptoms() const { return symptoms; }
 bool Infection::get_sought_care() const { return sought_care; }
 
-Person::Person(size_t assigned_id, const Parameters* parameters, const RngHandler* rng_handler) {
-    id = assigned_id;
-    par = parameters;
-    rng = rng_handler;
-
-    vaccination_status = UNVACCINATED;
-    vaccination_time   = par->get("sim_duration") + 1;
-    vaccine_protection = std::vector<double>(NUM_STRAIN_TYPES, 0.0);
-
-    susceptibility = par->sample_susceptibility(this);
-}
+Person::Person(Population* population, size_t assigned_idx)
+    : pop(population),
+      idx(assigned_idx) {}
 
 Person::~Person() {}
 
-size_t Person::get_id() const { return id; }
+size_t Person::get_id() const { return pop->id[idx]; }
 
-double Person::get_susceptibility(StrainType strain) const { return susceptibility[strain]; }
-void Person::set_susceptibility(StrainType strain, double s) { susceptibility[strain] = s; }
+double Person::get_susceptibility(StrainType strain) const { return pop->susceptibility[strain][idx]; }
+void Person::set_susceptibility(StrainType strain, double s) { pop->susceptibility[strain][idx] = s; }
 
 double Person::get_current_susceptibility(StrainType strain, size_t time) const {
-    bool immunity_generated = (strain == INFLUENZA)
-                                  ? par->get("flu_inf_gen_immunity")
-                                  : par->get("nonflu_inf_gen_immunity");
-
-    bool immunity_wanes = (strain == INFLUENZA)
-                              ? par->get("flu_inf_immunity_wanes")
-                              : par->get("nonflu_inf_immunity_wanes");
+    const auto kinetics = pop->par->get_kinetics();
+    const bool immunity_generated = kinetics->infection_generates_immunity(strain);
+    const bool immunity_wanes     = kinetics->infection_immunity_wanes(strain);
 
     if (has_been_infected_with(strain)) {
         if (immunity_generated and immunity_wanes) {
-            const auto half_life = (strain == INFLUENZA)
-                                       ? par->get("flu_inf_immunity_half_life")
-                                       : par->get("nonflu_inf_immunity_half_life");
-
-            const auto waning_rate = util::exp_decay_rate_from_half_life(half_life);
-
-            const auto refractory_period = (strain == INFLUENZA)
-                                              ? par->get("flu_inf_refract_len")
-                                              : par->get("nonflu_inf_refract_len");
-
-            // this starts waning only after the refractory period length
-            // during the refractory period, suscep will be negative though this
-            // wont matter because is_susceptible_to() is false during the refractory period
-            const auto time_since_last_inf = time - (most_recent_infection(strain)->get_infection_time() + refractory_period);
-
-            // 1 - exp flips the decay and will allow suscep to rise from zero to its original value
-            return susceptibility[strain] * (1 - util::exp_decay(waning_rate, time_since_last_inf));
+            // waning only starts after the refractory period (see Kinetics) and the
+            // multiplier allows suscep to rise from zero to its original value
+            return get_susceptibility(strain) * kinetics->immunity_multiplier(strain, time, last_infection_time(strain));
         } else {
             // if immunity is generated and doesnt wane, the individual is perfectly protected forever (suscep = 0)
             // otherwise, when no immunity is generated, they have constant susceptibility
-            return (immunity_generated) ? 0 : susceptibility[strain];
+            return (immunity_generated) ? 0 : get_susceptibility(strain);
         }
     } else {
         // when no immunity is generated, the individual has constant susceptibility
-        return susceptibility[strain];
+        return get_susceptibility(strain);
     }
 }
 
-double Person::get_vaccine_protection(StrainType strain) const { return vaccine_protection[strain]; }
-void Person::set_vaccine_protection(StrainType strain, double vp) { vaccine_protection[strain] = vp; }
+double Person::get_vaccine_protection(StrainType strain) const { return pop->vaccine_protection[strain][idx]; }
+void Person::set_vaccine_protection(StrainType strain, double vp) { pop->vaccine_protection[strain][idx] = vp; }
 
 double Person::get_remaining_vaccine_protection(StrainType strain, size_t time) const {
-    const bool efficacy_wanes = (strain == INFLUENZA)
-                                    ? par->get("flu_vax_effect_wanes")
-                                    : par->get("nonflu_vax_effect_wanes");
-
-    if (efficacy_wanes) {
-        const auto half_life = (strain == INFLUENZA)
-                                   ? par->get("flu_vax_effect_half_life")
-                                   : par->get("nonflu_vax_effect_half_life");
-        const auto waning_lag = (strain == INFLUENZA)
-                                    ? par->get("flu_vax_effect_lag_til_waning")
-                                    : par->get("nonflu_vax_effect_lag_til_waning");
-
-        const auto waning_rate    = util::exp_decay_rate_from_half_life(half_life);
-        const auto time_since_vax = time - (vaccination_time + waning_lag);
-        return (time_since_vax < 0)
-               ? vaccine_protection[strain]
-               : vaccine_protection[strain] * util::exp_decay(waning_rate, time_since_vax);
+    const auto kinetics = pop->par->get_kinetics();
+    const auto vax_time = pop->vaccination_time[idx];
+
+    if (kinetics->vaccine_effect_wanes(strain) and (time >= vax_time)) {
+        return get_vaccine_protection(strain) * kinetics->vaccine_multiplier(strain, time, vax_time);
     } else {
-        return vaccine_protection[strain];
+        return get_vaccine_protection(strain);
     }
 }
 
-const std::vector<std::unique_ptr<Infection>>& Person::get_infection_history() const { return infection_history; }
-
-Infection* Person::attempt_infection(StrainType strain, size_t time) {
-    Infection* inf = nullptr;
+/**
+ * @details The uniform draws are supplied by the caller (see Community::transmission)
+ *          so that they can be generated in bulk for every exposure of the day.
+ */
+std::optional<Infection> Person::attempt_infection(StrainType strain, size_t time, const InfectionDraws& u) {
+    std::optional<Infection> inf;
     if (is_susceptible_to(strain, time)) {
         auto current_suscep = get_current_susceptibility(strain, time);
         current_suscep *= is_vaccinated() ? 1 - get_remaining_vaccine_protection(strain, time) : 1;
 
-        if (rng->draw_from_rng(INFECTION) < current_suscep) {
+        if (u.infection < current_suscep) {
             auto pr_symptoms    = (strain == INFLUENZA)
-                                      ? par->get("pr_sympt_flu")
-                                      : par->get("pr_sympt_nonflu");
+                                      ? pop->par->get(PR_SYMPT_FLU)
+                                      : pop->par->get(PR_SYMPT_NONFLU);
             auto pr_careseeking = (is_vaccinated())
-                                      ? par->get("pr_careseeking_vaxd")
-                                      : par->get("pr_careseeking_unvaxd");
-            auto sympt = (rng->draw_from_rng(INFECTION) < pr_symptoms) ? SYMPTOMATIC : ASYMPTOMATIC;
-            auto seek_care = sympt == SYMPTOMATIC ? rng->draw_from_rng(BEHAVIOR) < pr_careseeking : false;
-            infection_history.push_back(std::make_unique<Infection>(this, strain, time, sympt, seek_care));
+                                      ? pop->par->get(PR_CARESEEKING_VAXD)
+                                      : pop->par->get(PR_CARESEEKING_UNVAXD);
+            auto sympt = (u.symptoms < pr_symptoms) ? SYMPTOMATIC : ASYMPTOMATIC;
+            auto seek_care = sympt == SYMPTOMATIC ? u.care_seeking < pr_careseeking : false;
 
-            inf = infection_history.back().get();
+            inf.emplace(infect(strain, time, sympt, seek_care));
         }
     }
 
     return inf;
 }
 
+/**
+ * @details Records an infection whose outcome has already been decided (eg, by
+ *          the transmission kernel) and updates the per-strain infection state.
+ */
+Infection Person::infect(StrainType strain, size_t time, SymptomClass sympt, bool seek_care) {
+    pop->last_infection_time[idx]   = time;
+    pop->last_infection_strain[idx] = strain;
+    pop->strain_infection_time[strain][idx] = time;
+    pop->strain_infection_count[strain][idx]++;
+
+    return Infection(*this, strain, time, sympt, seek_care);
+}
+
+/**
+ * @details Only records the vaccination; the vaccine protection and the vaccinated
+ *          susceptibility are sampled in bulk for everyone vaccinated at the same
+ *          time (see Population::synthesize).
+ */
 bool Person::vaccinate(size_t time) {
-    if (vaccination_status == VACCINATED) { return false; }
-    vaccination_status = VACCINATED;
-    vaccination_time   = time;
-    vaccine_protection = par->sample_vaccine_effect();
-    susceptibility     = par->sample_susceptibility(this);
+    if (is_vaccinated()) { return false; }
+    pop->vaccination_status[idx] = VACCINATED;
+    pop->vaccination_time[idx]   = time;
     return true;
 }
 
-bool Person::has_been_infected() const { return infection_history.size() > 0; }
+bool Person::has_been_infected() const { return pop->last_infection_strain[idx] != NUM_STRAIN_TYPES; }
 
-bool Person::has_been_infected_with(StrainType strain) const {
-    return std::any_of(
-        infection_history.begin(),
-        infection_history.end(),
-        [strain](const std::unique_ptr<Infection>& i) { return i->get_strain() == strain; }
-    );
-}
+bool Person::has_been_infected_with(StrainType strain) const { return pop->strain_infection_count[strain][idx] > 0; }
 
-bool Person::is_vaccinated() const { return vaccination_status == VACCINATED; }
+bool Person::is_vaccinated() const { return pop->vaccination_status[idx] == VACCINATED; }
 
 bool Person::is_susceptible_to(StrainType strain, size_t time) const {
     // if within any infection refractory period, return false
-    const auto last_inf = most_recent_infection();
-    if (last_inf != nullptr) {
-        const auto time_since_last_inf = time - last_inf->get_infection_time();
-
-        double refractory_period = 0;
-        switch (last_inf->get_strain()) {
-            case INFLUENZA: { refractory_period = par->get("flu_inf_refract_len"); break; }
-            case NON_INFLUENZA: { refractory_period = par->get("nonflu_inf_refract_len"); break; }
-            default: { break; }
-        }
+    if (has_been_infected()) {
+        const auto time_since_last_inf = time - last_infection_time();
+
+        const auto refractory_period = pop->par->get_kinetics()->refractory_period(pop->last_infection_strain[idx]);
 
         if (time_since_last_inf < refractory_period) { return false; }
     }
@@ -186,27 +155,36 @@ bool Person::is_susceptible_to(StrainType strain, size_t time) const {
     return true;
 }
 
-Infection* Person::most_recent_infection() const {
-    auto inf = has_been_infected() ? infection_history.back().get() : nullptr;
-    return inf;
-}
+/**
+ * @details True when nothing that happens later in the simulation can make the
+ *          agent susceptible to the strain again: they have no baseline
+ *          susceptibility, they were infected and the immunity never wanes, or
+ *          they are perfectly protected by a vaccine that never wanes.
+ */
+bool Person::is_permanently_immune_to(StrainType strain) const {
+    const auto kinetics = pop->par->get_kinetics();
+
+    if (get_susceptibility(strain) <= 0) { return true; }
+
+    if (has_been_infected_with(strain) and kinetics->infection_generates_immunity(strain)
+        and not kinetics->infection_immunity_wanes(strain)) { return true; }
 
-Infection* Person::most_recent_infection(StrainType strain) const {
-    auto itr = std::find_if(infection_history.crbegin(),
-                            infection_history.crend(),
-                            [strain](const std::unique_ptr<Infection>& i) { return i->get_strain() == strain; });
+    if (is_vaccinated() and not kinetics->vaccine_effect_wanes(strain)
+        and get_vaccine_protection(strain) >= 1) { return true; }
 
-    return (itr != infection_history.crend()) ? itr->get() : nullptr;
+    return false;
 }
 
-size_t Person::last_infection_time() const { return most_recent_infection()->get_infection_time(); }
-size_t Person::last_infection_strain() const { return most_recent_infection()->get_strain(); }
+size_t Person::last_infection_time() const { return pop->last_infection_time[idx]; }
+size_t Person::last_infection_time(StrainType strain) const { return pop->strain_infection_time[strain][idx]; }
+size_t Person::last_infection_strain() const { return pop->last_infection_strain[idx]; }
+size_t Person::infection_count(StrainType strain) const { return pop->strain_infection_count[strain][idx]; }
 
 std::ostream& operator<<(std::ostream& o, const Person& p) {
-    return o << "Person ID: " << p.id << '\n'
-      << "\tsusceptibility (flu, nonflu): " << p.susceptibility[INFLUENZA] << ' ' << p.susceptibility[NON_INFLUENZA] << '\n'
-      << "\tvaccination status: " << p.vaccination_status << '\n'
-      << "\tvax protection (flu, nonflu): " << p.vaccine_protection[INFLUENZA] << ' ' << p.vaccine_protection[NON_INFLUENZA] << '\n';
+    return o << "Person ID: " << p.get_id() << '\n'
+      << "\tsusceptibility (flu, nonflu): " << p.get_susceptibility(INFLUENZA) << ' ' << p.get_susceptibility(NON_INFLUENZA) << '\n'
+      << "\tvaccination status: " << p.is_vaccinated() << '\n'
+      << "\tvax protection (flu, nonflu): " << p.get_vaccine_protection(INFLUENZA) << ' ' << p.get_vaccine_protection(NON_INFLUENZA) << '\n';
 }
 
 void Person::update_susceptibility() {}
\ No newline at end of file
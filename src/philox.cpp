@@ -0,0 +1,131 @@
+/**
+ * @file philox.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Philox4x32-10 counter-based generator and its GSL rng type.
+ *
+ * @copyright TBD
+ */
+#include <storyteller/philox.hpp>
+
+namespace philox {
+    namespace {
+        constexpr uint32_t M0 = 0xD2511F53;
+        constexpr uint32_t M1 = 0xCD9E8D57;
+        constexpr uint32_t W0 = 0x9E3779B9;
+        constexpr uint32_t W1 = 0xBB67AE85;
+
+        constexpr double TO_UNIT = 1.0 / 4294967296.0;  // 2^-32
+
+        // number of blocks generated together so the rounds vectorize across lanes
+        constexpr size_t LANES = 8;
+
+        inline void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+            const uint64_t p0 = (uint64_t) M0 * c0;
+            const uint64_t p1 = (uint64_t) M1 * c2;
+            const uint32_t hi0 = p0 >> 32, lo0 = (uint32_t) p0;
+            const uint32_t hi1 = p1 >> 32, lo1 = (uint32_t) p1;
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+        }
+
+        inline void increment(Counter& c, uint64_t n = 1) {
+            const uint64_t lo = ((uint64_t) c[1] << 32 | c[0]) + n;
+            if (lo < n) {
+                if (++c[2] == 0) { ++c[3]; }
+            }
+            c[0] = (uint32_t) lo;
+            c[1] = lo >> 32;
+        }
+
+        // LANES consecutive blocks starting at counter, written to out in stream order
+        void blocks(const Counter& counter, const Key& key, double* out) {
+            uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+            for (size_t l = 0; l < LANES; ++l) {
+                Counter c = counter;
+                increment(c, l);
+                c0[l] = c[0]; c1[l] = c[1]; c2[l] = c[2]; c3[l] = c[3];
+            }
+
+            uint32_t k0 = key[0], k1 = key[1];
+            for (int r = 0; r < 10; ++r) {
+                for (size_t l = 0; l < LANES; ++l) { round(c0[l], c1[l], c2[l], c3[l], k0, k1); }
+                k0 += W0;
+                k1 += W1;
+            }
+
+            for (size_t l = 0; l < LANES; ++l) {
+                out[4 * l + 0] = c0[l] * TO_UNIT;
+                out[4 * l + 1] = c1[l] * TO_UNIT;
+                out[4 * l + 2] = c2[l] * TO_UNIT;
+                out[4 * l + 3] = c3[l] * TO_UNIT;
+            }
+        }
+
+        void refill(State* s) {
+            s->buffer = block(s->counter, s->key);
+            increment(s->counter);
+            s->next = 0;
+        }
+
+        void set(void* vstate, unsigned long int seed) {
+            auto s = static_cast<State*>(vstate);
+            const uint64_t seed64 = seed;
+            s->key     = {(uint32_t) seed64, (uint32_t) (seed64 >> 32)};
+            s->counter = {0, 0, 0, 0};
+            s->buffer  = {0, 0, 0, 0};
+            s->next    = 4;
+        }
+
+        unsigned long int get(void* vstate) {
+            auto s = static_cast<State*>(vstate);
+            if (s->next == 4) { refill(s); }
+            return s->buffer[s->next++];
+        }
+
+        double get_double(void* vstate) { return get(vstate) * TO_UNIT; }
+
+        const gsl_rng_type philox4x32_type = {
+            "philox4x32-10",
+            0xffffffffUL,
+            0,
+            sizeof(State),
+            &set,
+            &get,
+            &get_double
+        };
+    }
+
+    Counter block(Counter counter, Key key) {
+        uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < 10; ++r) {
+            round(c0, c1, c2, c3, k0, k1);
+            k0 += W0;
+            k1 += W1;
+        }
+        return {c0, c1, c2, c3};
+    }
+
+    void fill_uniform(State* s, double* out, size_t n) {
+        size_t i = 0;
+
+        // use up the partially consumed block first
+        while ((i < n) and (s->next < 4)) { out[i++] = s->buffer[s->next++] * TO_UNIT; }
+
+        // then whole batches of blocks straight into the output
+        for (; i + 4 * LANES <= n; i += 4 * LANES) {
+            blocks(s->counter, s->key, out + i);
+            increment(s->counter, LANES);
+        }
+
+        // and buffer one more block for the remainder
+        while (i < n) {
+            if (s->next == 4) { refill(s); }
+            out[i++] = s->buffer[s->next++] * TO_UNIT;
+        }
+    }
+}
+
+const gsl_rng_type* gsl_rng_philox4x32 = &philox::philox4x32_type;
\ No newline at end of file
@@ -0,0 +1,350 @@
+/**
+ * @file population.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the Population class that stores the state of every agent in
+ *        a synthetic population using contiguous per-field arrays.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <storyteller/population.hpp>
+#include <storyteller/person.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/kinetics.hpp>
+#include <storyteller/utility.hpp>
+#include <storyteller/thread_pool.hpp>
+#include <storyteller/population_cache.hpp>
+#include <storyteller/checkpoint.hpp>
+
+Population::Population(const Parameters* parameters, const RngHandler* rng_handler, std::pmr::memory_resource* resource)
+    : id(resource),
+      vaccination_status(resource),
+      vaccination_time(resource),
+      susceptibility(NUM_STRAIN_TYPES, resource),
+      vaccine_protection(NUM_STRAIN_TYPES, resource),
+      last_infection_time(resource),
+      last_infection_strain(resource),
+      strain_infection_time(NUM_STRAIN_TYPES, resource),
+      strain_infection_count(NUM_STRAIN_TYPES, resource),
+      gatherers{},
+      par(parameters),
+      rng(rng_handler) {
+    reset();
+}
+
+Population::~Population() {}
+
+/**
+ * @details Sizes every array for the current parameters' population and returns
+ *          every agent to its unsynthesized, never-infected state. A population
+ *          that has held at least as many agents before reuses its storage.
+ */
+void Population::reset() {
+    const size_t pop_size = par->get(POP_SIZE);
+    const size_t never    = par->get(SIM_DURATION) + 1;
+
+    // all containers were handed the resource above (nested vectors inherit it),
+    // so these only ever allocate from the simulation arena
+    id.resize(pop_size);
+    vaccination_status.assign(pop_size, UNVACCINATED);
+    vaccination_time.assign(pop_size, never);
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        susceptibility[s].assign(pop_size, 1.0);
+        vaccine_protection[s].assign(pop_size, 0.0);
+    }
+    last_infection_time.assign(pop_size, never);
+    last_infection_strain.assign(pop_size, NUM_STRAIN_TYPES);
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        strain_infection_time[s].assign(pop_size, never);
+        strain_infection_count[s].assign(pop_size, 0);
+    }
+
+    for (size_t i = 0; i < pop_size; ++i) {
+        id[i] = i;
+    }
+}
+
+size_t Population::size() const { return id.size(); }
+
+Person Population::operator[](size_t idx) { return Person(this, idx); }
+
+void Population::set_parameters(const Parameters* parameters) { par = parameters; }
+
+/**
+ * @details Synthesizes every agent's vaccination status, susceptibility, and
+ *          vaccine protection. The population is split into fixed-size blocks
+ *          that each draw from their own stream seeded from (seed, time, block),
+ *          so the blocks can be synthesized on any thread in any order and the
+ *          population only depends on the seed.
+ *
+ * @return size_t Number of agents vaccinated at time
+ */
+size_t Population::synthesize(size_t time, ThreadPool* pool) {
+    const size_t pop_size = size();
+    const size_t n_blocks = (pop_size + SYNTHESIS_BLOCK_SIZE - 1) / SYNTHESIS_BLOCK_SIZE;
+
+    std::vector<size_t> block_vaccinated(n_blocks, 0);
+    auto synthesize_nth_block = [&](size_t block) {
+        const size_t first = block * SYNTHESIS_BLOCK_SIZE;
+        const size_t last  = std::min(first + SYNTHESIS_BLOCK_SIZE, pop_size);
+        block_vaccinated[block] = synthesize_block(time, block, first, last);
+    };
+
+    if (pool) {
+        pool->parallel_for(n_blocks, synthesize_nth_block);
+    } else {
+        for (size_t block = 0; block < n_blocks; ++block) { synthesize_nth_block(block); }
+    }
+
+    return std::accumulate(block_vaccinated.begin(), block_vaccinated.end(), size_t(0));
+}
+
+/**
+ * @details Two particles whose keys are equal synthesize identical populations
+ *          (for the same synthesis time, random number backend, and common random
+ *          numbers mode).
+ */
+std::vector<double> Population::synthesis_key(const ParameterSet& pars) {
+    std::vector<double> key;
+    key.reserve(SYNTHESIS_PARAMETERS.size());
+    for (auto id : SYNTHESIS_PARAMETERS) { key.push_back(pars[id]); }
+    return key;
+}
+
+/**
+ * @details The key of a simulation whose random number streams are seeded with
+ *          seed rather than the SEED in pars: the realizations of an ensemble
+ *          share one ParameterSet, but each synthesizes from its own seed.
+ */
+std::vector<double> Population::synthesis_key(const ParameterSet& pars, unsigned long int seed) {
+    auto key = synthesis_key(pars);
+    for (size_t i = 0; i < SYNTHESIS_PARAMETERS.size(); ++i) {
+        if (SYNTHESIS_PARAMETERS[i] == SEED) { key[i] = seed; }
+    }
+    return key;
+}
+
+/**
+ * @details Copies exactly the attributes that synthesize() writes, so restoring
+ *          the snapshot into a newly constructed population of the same size
+ *          reproduces the synthesized one.
+ */
+void Population::save(PopulationSnapshot& snapshot) const {
+    snapshot.vaccination_status.assign(vaccination_status.begin(), vaccination_status.end());
+    snapshot.vaccination_time.assign(vaccination_time.begin(), vaccination_time.end());
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        snapshot.susceptibility[s].assign(susceptibility[s].begin(), susceptibility[s].end());
+        snapshot.vaccine_protection[s].assign(vaccine_protection[s].begin(), vaccine_protection[s].end());
+    }
+}
+
+void Population::restore(const PopulationSnapshot& snapshot) {
+    std::copy(snapshot.vaccination_status.begin(), snapshot.vaccination_status.end(), vaccination_status.begin());
+    std::copy(snapshot.vaccination_time.begin(), snapshot.vaccination_time.end(), vaccination_time.begin());
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        std::copy(snapshot.susceptibility[s].begin(), snapshot.susceptibility[s].end(), susceptibility[s].begin());
+        std::copy(snapshot.vaccine_protection[s].begin(), snapshot.vaccine_protection[s].end(), vaccine_protection[s].begin());
+    }
+}
+
+/**
+ * @details Writes every agent attribute that can change during a simulation (ie,
+ *          all but the ids).
+ */
+void Population::save_state(checkpoint::Writer& out) const {
+    out.write(vaccination_status);
+    out.write(vaccination_time);
+    out.write(susceptibility);
+    out.write(vaccine_protection);
+    out.write(last_infection_time);
+    out.write(last_infection_strain);
+    out.write(strain_infection_time);
+    out.write(strain_infection_count);
+}
+
+void Population::load_state(checkpoint::Reader& in) {
+    in.read(vaccination_status);
+    in.read(vaccination_time);
+    in.read(susceptibility);
+    in.read(vaccine_protection);
+    in.read(last_infection_time);
+    in.read(last_infection_strain);
+    in.read(strain_infection_time);
+    in.read(strain_infection_count);
+}
+
+/**
+ * @details Vaccination status is assigned first, so that each susceptibility is
+ *          sampled exactly once from the distribution for the agent's status and
+ *          vaccine protection is only sampled for the vaccinated. Each column is
+ *          then sampled in bulk for all of the block's agents with that status.
+ */
+size_t Population::synthesize_block(size_t time, size_t block, size_t first, size_t last) {
+    if (rng->uses_common_random_numbers()) { return synthesize_keyed_block(time, first, last); }
+
+    gsl_rng* stream = gsl_rng_alloc(rng->get_backend_type());
+    rng->seed_stream(stream, VACCINATION, time, block);
+
+    const size_t n = last - first;
+    std::vector<double> column(n);
+
+    const double pr_vaccination = par->get(PR_VAX);
+    if (pr_vaccination > 0) { RngHandler::fill_uniform(stream, column.data(), n); }
+
+    std::array<std::vector<size_t>, NUM_VACCINATION_STATUSES> members; // [status] agents
+    for (size_t i = 0; i < n; ++i) {
+        const size_t agent = first + i;
+        const auto status  = (pr_vaccination > 0 and column[i] < pr_vaccination) ? VACCINATED : UNVACCINATED;
+        vaccination_status[agent] = status;
+        if (status == VACCINATED) { vaccination_time[agent] = time; }
+        members[status].push_back(agent);
+    }
+
+    const auto& vaccinated = members[VACCINATED];
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        const auto strain = (StrainType) s;
+
+        for (size_t v = 0; v < NUM_VACCINATION_STATUSES; ++v) {
+            const auto& agents = members[v];
+            par->sample_susceptibility((VaccinationStatus) v, strain, stream, column.data(), agents.size());
+            for (size_t i = 0; i < agents.size(); ++i) { susceptibility[s][agents[i]] = column[i]; }
+        }
+
+        par->sample_vaccine_effect(strain, stream, column.data(), vaccinated.size());
+        for (size_t i = 0; i < vaccinated.size(); ++i) { vaccine_protection[s][vaccinated[i]] = column[i]; }
+    }
+
+    gsl_rng_free(stream);
+    return vaccinated.size();
+}
+
+/**
+ * @details Common random numbers mode: every agent's vaccination, susceptibility,
+ *          and vaccine protection come from their own keyed draws (see CrnDraw),
+ *          mapped through each distribution's quantile function, so an agent's
+ *          attributes only depend on the seed, their index, and the parameters.
+ */
+size_t Population::synthesize_keyed_block(size_t time, size_t first, size_t last) {
+    static_assert(CRN_SUSCEPTIBILITY + NUM_STRAIN_TYPES <= CRN_VAX_EFFECT, "susceptibility draws overflow their block");
+    static_assert(CRN_VACCINATION / 4 == CRN_SUSCEPTIBILITY / 4, "vaccination and susceptibility draws share a block");
+
+    const double pr_vaccination = par->get(PR_VAX);
+
+    std::array<std::vector<size_t>, NUM_VACCINATION_STATUSES> members;              // [status] agents
+    std::array<std::array<std::vector<double>, NUM_STRAIN_TYPES>, NUM_VACCINATION_STATUSES> u_suscep; // [status][strain]
+    std::array<std::vector<double>, NUM_STRAIN_TYPES> u_vax_effect;                 // [strain] of the vaccinated
+
+    for (size_t agent = first; agent < last; ++agent) {
+        const auto u      = rng->keyed_block(agent, time, CRN_VACCINATION / 4);
+        const auto status = (u[CRN_VACCINATION % 4] < pr_vaccination) ? VACCINATED : UNVACCINATED;
+        vaccination_status[agent] = status;
+        members[status].push_back(agent);
+        for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) { u_suscep[status][s].push_back(u[(CRN_SUSCEPTIBILITY + s) % 4]); }
+
+        if (status == VACCINATED) {
+            vaccination_time[agent] = time;
+            const auto v = rng->keyed_block(agent, time, CRN_VAX_EFFECT / 4);
+            for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) { u_vax_effect[s].push_back(v[(CRN_VAX_EFFECT + s) % 4]); }
+        }
+    }
+
+    const auto& vaccinated = members[VACCINATED];
+    std::vector<double> column(last - first);
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        const auto strain = (StrainType) s;
+
+        for (size_t v = 0; v < NUM_VACCINATION_STATUSES; ++v) {
+            const auto& agents = members[v];
+            par->susceptibility_from_uniform((VaccinationStatus) v, strain, u_suscep[v][s].data(), column.data(), agents.size());
+            for (size_t i = 0; i < agents.size(); ++i) { susceptibility[s][agents[i]] = column[i]; }
+        }
+
+        par->vaccine_effect_from_uniform(strain, u_vax_effect[s].data(), column.data(), vaccinated.size());
+        for (size_t i = 0; i < vaccinated.size(); ++i) { vaccine_protection[s][vaccinated[i]] = column[i]; }
+    }
+
+    return vaccinated.size();
+}
+
+/**
+ * @details The immunity and waning flags are fixed once the parameters have been
+ *          validated, so each strain's gather is resolved to the instantiation
+ *          for its flags here rather than branching on them for every exposure.
+ *          Every combination is instantiated, so there is no generic fallback.
+ */
+void Population::specialize_transmission() {
+    static constexpr ExposedGatherer instantiations[NUM_IMMUNITY_MODES][2] = {
+        {&Population::gather_exposed_to<NO_IMMUNITY, false>,        &Population::gather_exposed_to<NO_IMMUNITY, true>},
+        {&Population::gather_exposed_to<PERMANENT_IMMUNITY, false>, &Population::gather_exposed_to<PERMANENT_IMMUNITY, true>},
+        {&Population::gather_exposed_to<WANING_IMMUNITY, false>,    &Population::gather_exposed_to<WANING_IMMUNITY, true>}
+    };
+
+    const auto kinetics = par->get_kinetics();
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        const auto strain = (StrainType) s;
+        gatherers[s] = instantiations[kinetics->immunity_mode(strain)][kinetics->vaccine_effect_wanes(strain)];
+    }
+}
+
+/**
+ * @details Writes, for each exposure, the agent's current susceptibility (zero if
+ *          they are not susceptible, eg during a refractory period), remaining
+ *          vaccine protection (zero if unvaccinated), and care-seeking probability.
+ *          These are the values Person::attempt_infection would use.
+ */
+void Population::gather_exposed(const std::pmr::vector<Exposure>& exposed, size_t time, double* susceptibility_out,
+                                double* vaccine_protection_out, double* pr_careseeking_out) const {
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        (this->*gatherers[s])(exposed, (StrainType) s, time, susceptibility_out, vaccine_protection_out, pr_careseeking_out);
+    }
+}
+
+/**
+ * @details Only the exposures to the given strain are written.
+ */
+template<ImmunityMode IMMUNITY, bool VAX_WANES>
+void Population::gather_exposed_to(const std::pmr::vector<Exposure>& exposed, StrainType strain, size_t time,
+                                   double* susceptibility_out, double* vaccine_protection_out,
+                                   double* pr_careseeking_out) const {
+    const auto kinetics = par->get_kinetics();
+    const double pr_careseeking[NUM_VACCINATION_STATUSES] = {par->get(PR_CARESEEKING_UNVAXD), par->get(PR_CARESEEKING_VAXD)};
+    double refractory_period[NUM_STRAIN_TYPES];
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) { refractory_period[s] = kinetics->refractory_period((StrainType) s); }
+
+    const auto& suscep          = susceptibility[strain];
+    const auto& protection      = vaccine_protection[strain];
+    const auto& infection_count = strain_infection_count[strain];
+    const auto& infection_time  = strain_infection_time[strain];
+
+    for (size_t i = 0; i < exposed.size(); ++i) {
+        if (exposed[i].strain != strain) continue;
+        const size_t a = exposed[i].agent;
+
+        // within any infection's refractory period the agent cannot be infected
+        const auto last_strain = last_infection_strain[a];
+        const bool refractory = (last_strain != NUM_STRAIN_TYPES)
+                                and (time - last_infection_time[a] < refractory_period[last_strain]);
+
+        double current = suscep[a];
+        if constexpr (IMMUNITY == PERMANENT_IMMUNITY) {
+            if (infection_count[a] > 0) { current = 0; }
+        } else if constexpr (IMMUNITY == WANING_IMMUNITY) {
+            if (infection_count[a] > 0) { current *= kinetics->immunity_multiplier(strain, time, infection_time[a]); }
+        }
+        susceptibility_out[i] = (refractory or current <= 0) ? 0.0 : current;
+
+        const auto status = vaccination_status[a];
+        double remaining = 0.0;
+        if (status == VACCINATED) {
+            remaining = protection[a];
+            if constexpr (VAX_WANES) {
+                if (time >= vaccination_time[a]) { remaining *= kinetics->vaccine_multiplier(strain, time, vaccination_time[a]); }
+            }
+        }
+        vaccine_protection_out[i] = remaining;
+        pr_careseeking_out[i]     = pr_careseeking[status];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/**
+ * @file population_cache.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the PopulationCache that keeps synthesized populations so that
+ *        particles sharing the population parameters and seed can reuse them.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <storyteller/population_cache.hpp>
+
+PopulationCache::PopulationCache(size_t max_snapshots)
+    : capacity(max_snapshots),
+      hits(0),
+      misses(0) {}
+
+std::shared_ptr<const PopulationSnapshot> PopulationCache::find(const std::vector<double>& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& snapshot : snapshots) {
+        if (snapshot->key == key) {
+            ++hits;
+            return snapshot;
+        }
+    }
+    ++misses;
+    return nullptr;
+}
+
+/**
+ * @details A snapshot whose key is already cached (eg, synthesized concurrently by
+ *          another worker) is not stored twice.
+ */
+void PopulationCache::insert(std::shared_ptr<const PopulationSnapshot> snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capacity == 0) { return; }
+
+    auto same_key = [&](const auto& s) { return s->key == snapshot->key; };
+    if (std::any_of(snapshots.begin(), snapshots.end(), same_key)) { return; }
+
+    if (snapshots.size() == capacity) { snapshots.pop_front(); }
+    snapshots.push_back(std::move(snapshot));
+}
+
+size_t PopulationCache::get_hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t PopulationCache::get_misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
\ No newline at end of file
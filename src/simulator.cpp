@@ -6,6 +6,7 @@
  *
  * @copyright TBD
  */
+#include <algorithm>
 #include <memory>
 #include <iostream>
 #include <fstream>
@@ -19,42 +20,111 @@
 
 #include <storyteller/simulator.hpp>
 #include <storyteller/community.hpp>
+#include <storyteller/population.hpp>
 #include <storyteller/parameters.hpp>
 #include <storyteller/person.hpp>
 #include <storyteller/ledger.hpp>
 #include <storyteller/utility.hpp>
 #include <storyteller/database_handler.hpp>
 #include <storyteller/tome.hpp>
+#include <storyteller/arena.hpp>
+#include <storyteller/checkpoint.hpp>
 
 namespace fs = std::filesystem;
 
-Simulator::Simulator(const Parameters* parameters, DatabaseHandler* dbh, const RngHandler* rngh)
+Simulator::Simulator(const Parameters* parameters, DatabaseHandler* dbh, const RngHandler* rngh, SimulationArena* simulation_arena)
     : sim_time(0),
+      serial(parameters->simulation_serial),
+      checkpoint_interval(0),
+      checkpointed(false),
+      interrupted(false),
       rng_handler(rngh),
       par(parameters),
-      db_handler(dbh) {
-    community = std::make_unique<Community>(par, rngh);
+      db_handler(dbh),
+      arena(simulation_arena) {
+    auto resource = (arena) ? arena->get_resource() : std::pmr::get_default_resource();
+    community = std::make_unique<Community>(par, rngh, resource);
 }
 
 Simulator::~Simulator() {}
 
 void Simulator::set_flags(std::map<std::string, bool> flags) { sim_flags = flags; }
 
+void Simulator::set_serial(size_t simulation_serial) { serial = simulation_serial; }
+
+void Simulator::set_thread_pool(ThreadPool* pool) { community->set_thread_pool(pool); }
+
+void Simulator::set_population_cache(PopulationCache* cache) { community->set_population_cache(cache); }
+
+void Simulator::set_synthpop(const SynthpopFile* file) { community->set_synthpop(file); }
+
+void Simulator::set_checkpoint_interval(size_t days) { checkpoint_interval = days; }
+
+bool Simulator::was_interrupted() const { return interrupted; }
+
 void Simulator::init() {
-    // vaccinate population before transmission starts
-    community->vaccinate_population(sim_time);
+    // the full infection history is only kept when a linelist will be written
+    community->ledger->set_record_infections(sim_flags["linelist"]);
+
+    // the immunity and waning flags are constant for the simulation, so transmission
+    // is specialized on them once the parameters have been validated
+    community->population->specialize_transmission();
+
+    // synthesize (and vaccinate) the population before transmission starts
+    community->synthesize_population(sim_time);
+
+    // only agents that can still be infected are considered for exposure
+    community->init_eligible_agents();
+}
+
+void Simulator::reset() {
+    sim_time     = 0;
+    serial       = par->simulation_serial;
+    checkpointed = false;
+    interrupted  = false;
+    community->reset();
 }
 
 /**
  * @details Main function of the simulation that houses the core simulation loop.
+ *          Checkpoints are written between days, so that a resumed simulation
+ *          continues with the first day that was not simulated.
+ */
+void Simulator::simulate() { simulate_until(par->get(SIM_DURATION)); }
+
+/**
+ * @details Checkpoints (periodic or on SIGTERM) are only written when a checkpoint
+ *          interval has been set.
  */
-void Simulator::simulate() {
+void Simulator::simulate_until(size_t time) {
+    const size_t end_time = std::min(time, (size_t) par->get(SIM_DURATION));
+
     // core simulation loop
-    for (; sim_time < par->get("sim_duration"); ++sim_time) {
+    while (sim_time < end_time) {
         tick();
+        ++sim_time;
+        if ((sim_time == end_time) or (checkpoint_interval == 0)) { continue; }
+
+        if (checkpoint::termination_requested()) {
+            save_checkpoint();
+            interrupted = true;
+            break;
+        }
+        if (sim_time % checkpoint_interval == 0) { save_checkpoint(); }
     }
 }
 
+/**
+ * @details Everything that depends on the other parameters (eg, the kinetics, the
+ *          specialized transmission, the eligible agents) stays as it is.
+ */
+void Simulator::branch(const Parameters* parameters, DatabaseHandler* dbh, size_t simulation_serial) {
+    par        = parameters;
+    db_handler = dbh;
+    serial     = simulation_serial;
+    community->set_parameters(parameters);
+}
+
 void Simulator::tick() {
     community->transmission(sim_time);
 }
@@ -72,7 +142,7 @@ void Simulator::results() {
     if (sim_flags["verbose"]) {
         if (sim_flags.at("very_verbose")) {
             std::cerr << "t\tpr_exposure(flu|nflu)\tc_vaxflu_mais\tc_unvaxflu_mais\tc_vaxnflu_mais\tc_unvaxnflu_mais\ttnd_ve\n";
-            for (size_t t = 0; t < par->get("sim_duration"); ++t) {
+            for (size_t t = 0; t < par->get(SIM_DURATION); ++t) {
                 std::cerr << t << '\t'
                           << par->strain_probs[t][INFLUENZA] << " | " << par->strain_probs[t][NON_INFLUENZA] << "\t\t"
                           << ledger->get_cumul_mais(VACCINATED, INFLUENZA, t) << "\t\t"
@@ -82,7 +152,7 @@ void Simulator::results() {
                           << ledger->get_tnd_ve_est(t) << '\n';
             }
         }
-        auto pop_size = par->get("pop_size");
+        auto pop_size = par->get(POP_SIZE);
 
         auto total_vaxd_flu_infs = ledger->total_infections(VACCINATED, INFLUENZA);
         auto total_vaxd_flu_cases = ledger->total_sympt_infections(VACCINATED, INFLUENZA);
@@ -91,7 +161,7 @@ void Simulator::results() {
         auto total_vaxd_nonflu_cases = ledger->total_sympt_infections(VACCINATED, NON_INFLUENZA);
         auto total_vaxd_nonflu_mai = ledger->total_mai(VACCINATED, NON_INFLUENZA);
         auto vax_coverage = (double) ledger->total_vaccinations() / pop_size;
-        auto final_tnd_ve = ledger->get_tnd_ve_est(par->get("sim_duration") - 1);
+        auto final_tnd_ve = ledger->get_tnd_ve_est(par->get(SIM_DURATION) - 1);
 
         // print basic simulation results to the terminal
         std::cerr << "rng seed:            " << rng_handler->get_seed() << '\n'
@@ -104,9 +174,8 @@ void Simulator::results() {
                 << "final tnd ve (vax%):      " << final_tnd_ve << " ("<< vax_coverage*100 << "%)" << '\n';
     }
 
-    // { // generate linelist csv (sim.linelist)
-    //     ledger->generate_linelist_csv();
-    // }
+    // generate linelist csv if requested by the user
+    if (sim_flags["linelist"]) ledger->generate_linelist_csv();
 
     // generate the simulation dashboard if requested by the user
     if (sim_flags["simvis"]) ledger->generate_simvis_csv();
@@ -121,24 +190,107 @@ void Simulator::results() {
             db_handler->write_metrics(ledger, par);
         }
     }
+
+    // a finished simulation no longer needs its checkpoint, but one whose metrics
+    // went to the database keeps it until its job's end is committed
+    if (checkpointed) {
+        if (sim_flags["simulate"] and not sim_flags["hpc_mode"]) {
+            db_handler->set_job_checkpoint(checkpoint_path());
+        } else {
+            fs::remove(checkpoint_path());
+        }
+    }
+}
+
+std::filesystem::path Simulator::checkpoint_path() const {
+    return fs::path(par->tome->get_path("checkpoints")) / ("checkpoint_" + std::to_string(serial) + ".bin");
+}
+
+checkpoint::Header Simulator::checkpoint_header() const {
+    checkpoint::Header header;
+    header.magic                 = checkpoint::Header::MAGIC;
+    header.version               = checkpoint::Header::VERSION;
+    header.serial                = serial;
+    header.seed                  = rng_handler->get_seed();
+    header.pop_size              = par->get(POP_SIZE);
+    header.sim_duration          = par->get(SIM_DURATION);
+    header.sim_time              = sim_time;
+    header.rng_backend           = rng_handler->get_backend();
+    header.common_random_numbers = rng_handler->uses_common_random_numbers();
+    header.n_chunks              = community->get_n_chunks();
+    return header;
+}
+
+/**
+ * @return std::optional<size_t> Day the checkpoint resumes from (empty without a
+ *         checkpoint)
+ */
+std::optional<size_t> Simulator::checkpoint_time() const {
+    const auto path = checkpoint_path();
+    if (not fs::exists(path)) { return std::nullopt; }
+    return checkpoint::read_header(path).sim_time;
+}
+
+/**
+ * @details Writes the header followed by the random number generator states and
+ *          the community's state (see Community::save_state).
+ */
+void Simulator::save_checkpoint() {
+    checkpoint::Writer out(checkpoint_path());
+    out.write(checkpoint_header());
+    rng_handler->save_state(out);
+    community->save_state(out);
+    out.commit();
+    checkpointed = true;
+
+    if (sim_flags["verbose"]) { std::cerr << serial << " checkpointed at day " << sim_time << '\n'; }
+}
+
+/**
+ * @details A checkpoint written for a different particle, seed, or mode is a fatal
+ *          error rather than silently ignored.
+ */
+bool Simulator::resume() {
+    const auto path = checkpoint_path();
+    if (not fs::exists(path)) { return false; }
+
+    checkpoint::Reader in(path);
+    checkpoint::Header header;
+    in.read(header);
+    if (not header.is_compatible(checkpoint_header())) {
+        std::cerr << "ERROR: checkpoint " << path << " does not match simulation " << serial << '\n';
+        exit(-1);
+    }
+
+    rng_handler->load_state(in);
+    community->load_state(in);
+    sim_time = header.sim_time;
+    checkpointed = true;
+
+    std::cerr << "resumed at day " << sim_time << "... ";
+    return true;
 }
 
-std::vector<Person*> Simulator::get_population() const {
+Population* Simulator::get_population() const {
     return community->get_population();
 }
 
+const Ledger* Simulator::get_ledger() const {
+    return community->ledger.get();
+}
+
 void Simulator::write_metrics_csv() {
-    auto file_name = "metrics_" + std::to_string(par->simulation_serial) + ".csv";
+    auto file_name = "metrics_" + std::to_string(serial) + ".csv";
     auto file_path = fs::path(par->tome->get_path("out_dir")) / file_name;
 
-    size_t n_rows = par->get("sim_duration");
+    size_t n_rows = par->get(SIM_DURATION);
     std::vector<std::string> csv_rows_to_write(n_rows + 1);
     csv_rows_to_write[0] = "serial,time,c_vax_flu_inf,c_vax_nonflu_inf,c_unvax_flu_inf,c_unvax_nonflu_inf,c_vax_flu_mai,c_vax_nonflu_mai,c_unvax_flu_mai,c_unvax_nonflu_mai,tnd_ve_est\n";
 
     auto ledger = community->ledger.get();
     std::stringstream row;
     for (size_t t = 0; t < n_rows; ++t) {
-        row << par->simulation_serial << ","
+        row << serial << ","
             << t << ","
             << ledger->get_cumul_infs(VACCINATED, INFLUENZA, t) << ","
             << ledger->get_cumul_infs(VACCINATED, NON_INFLUENZA, t) << ","
@@ -15,6 +15,13 @@
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/wait.h>
 
 #define SOL_ALL_SAFETIES_ON 1
 #include <sol/sol.hpp>
@@ -23,10 +30,20 @@
 #include <storyteller/storyteller.hpp>
 #include <storyteller/tome.hpp>
 #include <storyteller/simulator.hpp>
+#include <storyteller/ensemble.hpp>
+#include <storyteller/batch_worker.hpp>
 #include <storyteller/parameters.hpp>
 #include <storyteller/utility.hpp>
 #include <storyteller/database_handler.hpp>
 #include <storyteller/person.hpp>
+#include <storyteller/population.hpp>
+#include <storyteller/arena.hpp>
+#include <storyteller/thread_pool.hpp>
+#include <storyteller/population_cache.hpp>
+#include <storyteller/checkpoint.hpp>
+#include <storyteller/synthpop_file.hpp>
+#include <storyteller/database_connection.hpp>
+#include <storyteller/database_writer.hpp>
 
 namespace fs = std::filesystem;
 
@@ -37,6 +54,16 @@ namespace fs = std::filesystem;
 Storyteller::Storyteller(int argc, char* argv[])
     : simulation_serial(-1),
       batch_size(1),
+      num_threads(0),
+      ensemble_size(0),
+      num_workers(0),
+      population_cache_size(0),
+      checkpoint_interval(0),
+      branch_day(0),
+      db_group_size(16),
+      db_group_seconds(10.0),
+      db_writer_megabytes(256),
+      rng_backend("philox"),
       tome_path(""),
       simulator(nullptr),
       operation_to_perform(NUM_OPERATION_TYPES),
@@ -44,6 +71,9 @@ Storyteller::Storyteller(int argc, char* argv[])
     // inititalize the lua virtual machine using sol2 library
     lua_vm = std::make_unique<sol::state>();
 
+    // simulation storage is drawn from an arena that is rewound between particles
+    arena = std::make_unique<SimulationArena>();
+
     // parse command-line arguments using Argh! library
     cmdl_args.parse(argc, argv, argh::parser::PREFER_PARAM_FOR_UNREG_OPTION);
 
@@ -52,6 +82,7 @@ Storyteller::Storyteller(int argc, char* argv[])
     simulation_flags["init"]         = cmdl_args["init"];
     simulation_flags["simulate"]     = cmdl_args["simulate"];
     simulation_flags["simvis"]       = cmdl_args["simvis"];
+    simulation_flags["linelist"]     = cmdl_args["linelist"];
     simulation_flags["quiet"]        = cmdl_args[{"-q", "--quiet"}];
     simulation_flags["verbose"]      = cmdl_args[{"-v", "--verbose"}];
     simulation_flags["very_verbose"] = cmdl_args[{"-vv", "--very-verbose"}];
@@ -60,6 +91,8 @@ Storyteller::Storyteller(int argc, char* argv[])
     simulation_flags["hpc_slurp"]    = cmdl_args["slurp"];
     simulation_flags["hpc_clean"]    = cmdl_args["clean"];
     simulation_flags["exp_report"]   = cmdl_args["report"];
+    simulation_flags["crn"]          = cmdl_args["crn"];
+    simulation_flags["resume"]       = cmdl_args["resume"];
 
     if (simulation_flags.at("very_verbose")) simulation_flags.at("verbose") = true;
 
@@ -72,12 +105,91 @@ Storyteller::Storyteller(int argc, char* argv[])
     // extract core config file path or default to empty string
     cmdl_args({"-t", "--tome"}, "") >> tome_path;
 
+    // extract number of transmission threads (0, the default, is the serial mode)
+    cmdl_args({"--threads"}, 0) >> num_threads;
+
+    // extract max number of realizations simulated together (0 defers to the tome)
+    cmdl_args({"--ensemble"}, 0) >> ensemble_size;
+
+    // extract number of particles simulated concurrently (0 defers to the tome)
+    cmdl_args({"--workers"}, 0) >> num_workers;
+
+    // extract max number of synthesized populations kept for reuse (-1 defers to the tome)
+    int pop_cache_size = -1;
+    cmdl_args({"--pop-cache"}, -1) >> pop_cache_size;
+
+    // extract days between checkpoints (0 defers to the tome)
+    cmdl_args({"--checkpoint"}, 0) >> checkpoint_interval;
+
+    // extract day that particles branch from a shared simulation (0 defers to the tome)
+    cmdl_args({"--branch-day"}, 0) >> branch_day;
+
+    // extract binary synthetic population path or default to empty string (ie, synthesize)
+    cmdl_args({"--synthpop"}, "") >> synthpop_path;
+
+    // extract rng backend name (philox by default, or mt19937)
+    std::string rng_name;
+    cmdl_args({"--rng"}, "") >> rng_name;
+    if (not rng_name.empty()) rng_backend = rng_name;
+
     // determine what operation the user called for
     if (sensible_inputs()) {
         if (simulation_flags["setup"]) {
             operation_to_perform = INITIALIZE_CONFIGS;
         } else {
-            tome = (tome_path.empty()) ? nullptr : std::make_unique<Tome>(lua_vm.get(), tome_path);
+            // simulations load the tome compiled by --init unless a config file has changed since
+            if (not tome_path.empty() and simulation_flags["simulate"] and not simulation_flags["init"]) {
+                tome = Tome::load_compiled(lua_vm.get(), tome_path);
+                if (tome and simulation_flags["verbose"]) std::cerr << "Loaded compiled tome\n";
+            }
+            if (not tome_path.empty() and not tome) tome = std::make_unique<Tome>(lua_vm.get(), tome_path);
+
+            // the tome can select the parallel mode if the command line does not
+            if (tome and (num_threads == 0) and tome->has_element("threads")) {
+                num_threads = tome->get_element_as<size_t>("threads");
+            }
+            if (tome and rng_name.empty() and tome->has_element("rng_backend")) {
+                rng_backend = tome->get_element_as<std::string>("rng_backend");
+            }
+            if (tome and (ensemble_size == 0) and tome->has_element("ensemble_size")) {
+                ensemble_size = tome->get_element_as<size_t>("ensemble_size");
+            }
+            if (ensemble_size == 0) ensemble_size = 1;
+            if (tome and (num_workers == 0) and tome->has_element("workers")) {
+                num_workers = tome->get_element_as<size_t>("workers");
+            }
+            if (num_workers == 0) num_workers = 1;
+            if (tome and (pop_cache_size < 0) and tome->has_element("population_cache_size")) {
+                pop_cache_size = tome->get_element_as<int>("population_cache_size");
+            }
+            if (tome and (checkpoint_interval == 0) and tome->has_element("checkpoint_interval")) {
+                checkpoint_interval = tome->get_element_as<size_t>("checkpoint_interval");
+            }
+            if (tome and synthpop_path.empty() and tome->has_element("synthpop_path")) {
+                fs::path path = tome->get_element_as<std::string>("synthpop_path");
+                synthpop_path = (path.is_absolute()) ? path : fs::path(tome->get_path("tome_rt")) / path;
+            }
+            if (tome and (branch_day == 0) and tome->has_element("branch_day")) {
+                branch_day = tome->get_element_as<size_t>("branch_day");
+            }
+            // by default every realization in flight can reuse its predecessor's population
+            population_cache_size = (pop_cache_size < 0) ? ensemble_size * num_workers : pop_cache_size;
+            if (tome and not simulation_flags["crn"] and tome->has_element("common_random_numbers")) {
+                simulation_flags["crn"] = tome->get_element_as<bool>("common_random_numbers");
+            }
+            if (tome and tome->has_element("database_journal_mode")) {
+                DatabaseConnection::for_path(tome->get_path("database"))
+                    ->set_journal_mode(tome->get_element_as<std::string>("database_journal_mode"));
+            }
+            if (tome and tome->has_element("database_group_size")) {
+                db_group_size = tome->get_element_as<size_t>("database_group_size");
+            }
+            if (tome and tome->has_element("database_group_seconds")) {
+                db_group_seconds = tome->get_element_as<double>("database_group_seconds");
+            }
+            if (tome and tome->has_element("database_writer_megabytes")) {
+                db_writer_megabytes = tome->get_element_as<size_t>("database_writer_megabytes");
+            }
 
             if (simulation_flags["init"]) {
                 operation_to_perform = INITIALIZE_DATABASE;
@@ -102,11 +214,15 @@ Storyteller::Storyteller(int argc, char* argv[])
 }
 
 Storyteller::~Storyteller() {
+    db_writer.reset(nullptr); // commits the batch's remaining results
+    if(thread_pool) thread_pool->shutdown();
+    if(simulation_flags["verbose"]) DatabaseConnection::report_counters(std::cerr);
     if(tome) tome->clean();
 }
 
 const Parameters* Storyteller::get_parameters() const { return parameters.get(); }
 const Tome* Storyteller::get_tome()             const { return tome.get(); }
+DatabaseWriter* Storyteller::get_database_writer() const { return db_writer.get(); }
 int Storyteller::get_serial()                   const { return simulation_serial; }
 size_t Storyteller::get_batch_size()            const { return batch_size; }
 std::string Storyteller::get_config_file()      const { return tome_path; }
@@ -166,6 +282,7 @@ int Storyteller::run() {
             return batch_simulation();
         }
         case GENERATE_SYNTHETIC_POPULATION: {
+            init_batch();
             init_simulation(0);
             auto ret = generate_synthpop();
             reset();
@@ -215,18 +332,26 @@ int Storyteller::setup_default_configs() {
     return 0;
 }
 
+/**
+ * @details Writes the population both as a CSV (for inspection) and as a binary
+ *          SynthpopFile that batch simulations can map with --synthpop.
+ */
 int Storyteller::generate_synthpop() {
+    SynthpopFile::write(tome->get_path("synthpop.bin"), *simulator->get_population(),
+                        Population::synthesis_key(parameters->get_values()), rng_handler.get(), 0);
+
     std::ofstream popfile(tome->get_path("synthpop"));
     popfile << "pid,flu_suscep,nonflu_suscep,vax_status,flu_vax_protec,nonflu_vax_protec\n";
 
     auto pop = simulator->get_population();
-    for (const auto& p : pop) {
-        popfile << p->get_id() << ','
-                  << p->get_susceptibility(INFLUENZA) << ','
-                  << p->get_susceptibility(NON_INFLUENZA) << ','
-                  << p->is_vaccinated() << ','
-                  << p->get_vaccine_protection(INFLUENZA) << ','
-                  << p->get_vaccine_protection(NON_INFLUENZA) << '\n';
+    for (size_t i = 0; i < pop->size(); ++i) {
+        const auto p = (*pop)[i];
+        popfile << p.get_id() << ','
+                  << p.get_susceptibility(INFLUENZA) << ','
+                  << p.get_susceptibility(NON_INFLUENZA) << ','
+                  << p.is_vaccinated() << ','
+                  << p.get_vaccine_protection(INFLUENZA) << ','
+                  << p.get_vaccine_protection(NON_INFLUENZA) << '\n';
     }
     popfile.close();
 
@@ -352,10 +477,41 @@ int Storyteller::generate_exp_report() {
  *          each simulation in the batch).
  */
 int Storyteller::batch_simulation() {
-    if (simulation_flags.at("hpc_mode")) { init_hpc_batch(); }
-    for (size_t i = 0; i < batch_size; ++i) {
+    if (not synthpop_path.empty()) {
+        synthpop = std::make_unique<SynthpopFile>(synthpop_path);
+    } else if (population_cache_size > 0) {
+        population_cache = std::make_unique<PopulationCache>(population_cache_size);
+    }
+
+    // preempted simulations checkpoint before stopping so that --resume can continue them
+    if (checkpoint_interval > 0) { checkpoint::install_termination_handler(); }
+
+    if ((branch_day > 0) and not simulation_flags["simvis"]) { return branch_simulation(); }
+
+    // particles hand their results to one thread that commits them in groups
+    // (branches are forked processes, and keep writing their own)
+    if (not simulation_flags.at("hpc_mode") and (db_group_size > 0)) {
+        db_writer = std::make_unique<DatabaseWriter>(DatabaseConnection::for_path(tome->get_path("database")),
+                                                     db_group_size, db_group_seconds, db_writer_megabytes,
+                                                     simulation_flags["verbose"]);
+    }
+
+    // the dashboard is drawn from a single simulation's population
+    if ((num_workers > 1) and not simulation_flags["simvis"]) { return parallel_batch_simulation(); }
+    if ((ensemble_size > 1) and not simulation_flags["simvis"]) { return ensemble_simulation(); }
+
+    const int serial_start = simulation_serial;
+    init_batch();
+
+    for (auto i : population_order()) {
+        simulation_serial = serial_start + i;
         init_simulation(i);
         simulator->simulate();
+        if (simulator->was_interrupted()) {
+            std::cerr << "interrupted, checkpointed " << simulation_serial << '\n';
+            reset();
+            return checkpoint::INTERRUPTED_RETURN_CODE;
+        }
         simulator->results();
 
         if (simulation_flags["simvis"]) {
@@ -368,18 +524,427 @@ int Storyteller::batch_simulation() {
         } else {
             db_handler->end_job(simulation_serial);
         }
-        reset();
-        ++simulation_serial;
     }
+    reset();
+    simulation_serial = serial_start + batch_size;
 
     if (simulation_flags.at("hpc_mode")) {
         db_handler = std::make_unique<DatabaseHandler>(this);
         db_handler->end_jobs(jobs);
     }
 
+    return flush_database_writer();
+}
+
+
+/**
+ * @details Realizations of the same particle in the batch are advanced together
+ *          by an Ensemble, at most #ensemble_size at a time. Each realization is
+ *          still its own job and reports its metrics under its own serial.
+ *          Ensembles always run in the serial transmission mode, and their results
+ *          are identical to those of batch_simulation in that mode.
+ */
+int Storyteller::ensemble_simulation() {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+    const int serial_start = simulation_serial;
+    init_batch();
+
+    for (const auto& indices : group_realizations()) {
+        init_ensemble(serial_start, indices);
+        ensemble->simulate();
+        if (ensemble->was_interrupted()) {
+            std::cerr << "interrupted, checkpointed " << serial_start + indices.front() << " ensemble\n";
+            reset();
+            return checkpoint::INTERRUPTED_RETURN_CODE;
+        }
+        ensemble->results();
+
+        for (size_t r = 0; r < indices.size(); ++r) {
+            if (hpc_mode) {
+                jobs[indices[r]].end();
+            } else {
+                ensemble_db_handlers[r]->end_job(serial_start + indices[r]);
+            }
+        }
+        reset();
+    }
+    simulation_serial = serial_start + batch_size;
+
+    if (hpc_mode) {
+        db_handler = std::make_unique<DatabaseHandler>(this);
+        db_handler->end_jobs(jobs);
+    }
+
+    return flush_database_writer();
+}
+
+/**
+ * @details Up to #num_workers BatchWorkers pull ensembles (single particles when
+ *          ensembles are disabled) from the batch in order until none are left.
+ *          Each worker has its own parameters and random number streams (and
+ *          shares the Tome, which simulations only read without calling into
+ *          Lua), so every realization's results are identical to those of
+ *          ensemble_simulation. Each worker reuses one simulation context, sized
+ *          for the batch's largest ensemble and particle, for all of its
+ *          ensembles. Workers always use the serial transmission mode, since the
+ *          particles themselves already occupy the cores. All database and output
+ *          file operations are serialized by a single writer mutex.
+ */
+int Storyteller::parallel_batch_simulation() {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+    const int serial_start = simulation_serial;
+    init_batch();
+
+    const auto ensembles = group_realizations();
+    const size_t n_workers = std::min(num_workers, ensembles.size());
+
+    size_t largest_ensemble = 0;
+    for (const auto& indices : ensembles) { largest_ensemble = std::max(largest_ensemble, indices.size()); }
+
+    std::mutex writer;
+    std::vector<std::unique_ptr<BatchWorker>> workers;
+    for (size_t w = 0; w < n_workers; ++w) {
+        workers.push_back(std::make_unique<BatchWorker>(this, simulation_flags, rng_backend, &writer,
+                                                        population_cache.get()));
+    }
+
+    std::atomic<size_t> next_ensemble(0);
+    std::atomic<bool> interrupted(false);
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        worker->set_checkpoint_interval(checkpoint_interval);
+        worker->set_synthpop(synthpop.get());
+        worker->set_ensemble_size(largest_ensemble);
+        threads.emplace_back([&, w = worker.get()]() {
+            for (size_t e = next_ensemble++; e < ensembles.size(); e = next_ensemble++) {
+                if (not w->run(serial_start, ensembles[e], batch_parsets, jobs)) {
+                    interrupted = true;
+                    break;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+    workers.clear();
+    if (interrupted) {
+        std::cerr << "interrupted, checkpointed the simulations in progress\n";
+        return checkpoint::INTERRUPTED_RETURN_CODE;
+    }
+    simulation_serial = serial_start + batch_size;
+
+    if (hpc_mode) {
+        db_handler = std::make_unique<DatabaseHandler>(this);
+        db_handler->end_jobs(jobs);
+    }
+
+    return flush_database_writer();
+}
+
+/**
+ * @details Called at the end of a batch rather than left to the destructor, so
+ *          that a batch whose results were given up on (its jobs are left
+ *          running, see DatabaseWriter::commit) does not report success.
+ */
+int Storyteller::flush_database_writer() {
+    if (not db_writer) { return 0; }
+
+    db_writer->flush();
+    if (db_writer->failed()) {
+        std::cerr << "ERROR: some results of the batch could not be committed, their jobs were left running\n";
+        return -1;
+    }
     return 0;
 }
 
+/**
+ * @details Particles that only differ in Simulator::BRANCH_PARAMETERS share the
+ *          same first #branch_day days, which are simulated once (the trunk) with
+ *          the parameters of the first particle of the group. The process is then
+ *          forked once per particle: each child continues from the trunk's state,
+ *          which the operating system shares copy-on-write, with the particle's
+ *          own parameters and reports under the particle's serial. So a branch's
+ *          metrics are those of its particle with the trunk's parameters before
+ *          #branch_day.
+ *
+ *          Up to #num_workers branches run at once. Forked children do not
+ *          inherit the #thread_pool's threads, so each child starts its own pool
+ *          in the parallel transmission mode. The trunk is never checkpointed;
+ *          branches are, like any other simulation.
+ */
+int Storyteller::branch_simulation() {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+    const int serial_start = simulation_serial;
+    init_batch();
+
+    bool interrupted = false;
+    bool failed = false;
+    std::map<pid_t, size_t> branch_of; // running child -> batch index
+    auto wait_for_branch = [&]() {
+        int status = 0;
+        const pid_t pid = wait(&status);
+        const size_t index = branch_of.at(pid);
+        branch_of.erase(pid);
+
+        const int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        if (code == 0) {
+            if (hpc_mode) jobs[index].end();
+        } else if (code == checkpoint::INTERRUPTED_RETURN_CODE) {
+            interrupted = true;
+        } else {
+            std::cerr << "ERROR: branch " << serial_start + index << " failed\n";
+            failed = true;
+        }
+    };
+
+    for (const auto& indices : group_branches()) {
+        init_trunk(indices.front());
+        std::cerr << serial_start + indices.front() << " trunk of " << indices.size() << " simulated until day "
+                  << branch_day << "... ";
+        simulator->simulate_until(branch_day);
+
+        for (auto index : indices) {
+            if (checkpoint::termination_requested()) break;
+            while (branch_of.size() >= num_workers) { wait_for_branch(); }
+
+            if (hpc_mode) jobs[index].start();
+            std::cerr.flush();
+            const pid_t pid = fork();
+            if (pid < 0) {
+                std::cerr << "ERROR: could not fork branch " << serial_start + index << '\n';
+                exit(-1);
+            } else if (pid == 0) {
+                run_branch(serial_start, index);
+            }
+            branch_of[pid] = index;
+        }
+        while (not branch_of.empty()) { wait_for_branch(); }
+        reset();
+
+        if (checkpoint::termination_requested()) interrupted = true;
+        if (interrupted or failed) break;
+    }
+
+    if (interrupted) {
+        std::cerr << "interrupted, checkpointed the branches in progress\n";
+        return checkpoint::INTERRUPTED_RETURN_CODE;
+    }
+    if (failed) { return -1; }
+    simulation_serial = serial_start + batch_size;
+
+    if (hpc_mode) {
+        db_handler = std::make_unique<DatabaseHandler>(this);
+        db_handler->end_jobs(jobs);
+    }
+
+    return 0;
+}
+
+/**
+ * @details Groups keep the order in which particles appear in the batch.
+ */
+std::vector<std::vector<size_t>> Storyteller::group_branches() const {
+    std::map<std::vector<double>, size_t> group_of; // parameter values without the branch parameters -> group
+    std::vector<std::vector<size_t>> groups;        // [group] batch indices
+    for (size_t i = 0; i < batch_parsets.size(); ++i) {
+        auto key = std::vector<double>();
+        for (size_t slot = 0; slot < batch_parsets[i].size(); ++slot) {
+            const auto& branch_pars = Simulator::BRANCH_PARAMETERS;
+            if (std::find(branch_pars.begin(), branch_pars.end(), slot) == branch_pars.end()) {
+                key.push_back(batch_parsets[i][slot]);
+            }
+        }
+
+        const auto [it, inserted] = group_of.try_emplace(key, groups.size());
+        if (inserted) groups.emplace_back();
+        groups[it->second].push_back(i);
+    }
+    return groups;
+}
+
+void Storyteller::init_trunk(const size_t index) {
+    rng_handler = std::make_unique<RngHandler>(RngHandler::backend_from_name(rng_backend));
+    rng_handler->set_common_random_numbers(simulation_flags.at("crn"));
+    parameters = std::make_unique<Parameters>(rng_handler.get(), db_handler.get(), tome.get());
+    parameters->read_parameters_from_batch(simulation_serial + index, batch_parsets[index]);
+
+    if (parameters->are_valid()) {
+        simulator = std::make_unique<Simulator>(parameters.get(), db_handler.get(), rng_handler.get(), arena.get());
+        simulator->set_flags(simulation_flags);
+        if (num_threads > 0) {
+            if (not thread_pool) thread_pool = std::make_unique<ThreadPool>(num_threads);
+            simulator->set_thread_pool(thread_pool.get());
+        }
+        simulator->set_population_cache(population_cache.get());
+        simulator->set_synthpop(synthpop.get());
+        simulator->init();
+    } else {
+        std::cerr << "ERROR: invalid parameters\n";
+        exit(-1);
+    }
+}
+
+/**
+ * @details Runs in the child process. The branch's Parameters get a throwaway
+ *          RngHandler, since reading parameters reseeds their handler and the
+ *          trunk's streams must carry on from where the trunk left them. The child
+ *          exits without destroying anything it shares with the parent (eg, the
+ *          parent's ThreadPool, whose threads do not exist in the child).
+ */
+void Storyteller::run_branch(const int serial_start, const size_t index) {
+    const size_t serial = serial_start + index;
+
+    std::unique_ptr<DatabaseHandler> branch_db_handler;
+    if (not simulation_flags.at("hpc_mode")) {
+        branch_db_handler = std::make_unique<DatabaseHandler>(this);
+        branch_db_handler->start_job(serial);
+    }
+
+    RngHandler parameter_rng(RngHandler::backend_from_name(rng_backend));
+    Parameters branch_parameters(&parameter_rng, branch_db_handler.get(), tome.get());
+    branch_parameters.read_parameters_from_batch(serial, batch_parsets[index]);
+    if (not branch_parameters.are_valid()) {
+        std::cerr << "ERROR: invalid parameters for branch " << serial << '\n';
+        _exit(EXIT_FAILURE);
+    }
+
+    std::unique_ptr<ThreadPool> branch_pool;
+    if (thread_pool) {
+        (void) thread_pool.release(); // its threads only exist in the parent
+        branch_pool = std::make_unique<ThreadPool>(num_threads);
+        simulator->set_thread_pool(branch_pool.get());
+    }
+
+    simulator->branch(&branch_parameters, branch_db_handler.get(), serial);
+    simulator->set_checkpoint_interval(checkpoint_interval);
+    if (simulation_flags.at("resume")) { simulator->resume(); }
+    simulator->simulate();
+    if (simulator->was_interrupted()) { _exit(checkpoint::INTERRUPTED_RETURN_CODE); }
+
+    simulator->results();
+    if (branch_db_handler) branch_db_handler->end_job(serial);
+
+    if (branch_pool) branch_pool->shutdown();
+    std::cerr.flush();
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @details Batch entries are realizations of the same particle when all of their
+ *          parameter values other than the seed are equal. Particles and their
+ *          realizations are visited in population_order(), and ensembles are then
+ *          ordered so that ensembles whose realizations synthesize the same
+ *          populations run one after another.
+ */
+std::vector<std::vector<size_t>> Storyteller::group_realizations() const {
+    std::map<std::vector<double>, size_t> particle_of; // parameter values without the seed -> particle
+    std::vector<std::vector<size_t>> particles;        // [particle] batch indices
+    for (auto i : population_order()) {
+        const auto& parset = batch_parsets[i];
+        std::vector<double> key;
+        key.reserve(parset.size());
+        for (size_t slot = 0; slot < parset.size(); ++slot) {
+            if (slot != SEED) key.push_back(parset[slot]);
+        }
+
+        const auto [it, inserted] = particle_of.try_emplace(key, particles.size());
+        if (inserted) particles.emplace_back();
+        particles[it->second].push_back(i);
+    }
+
+    std::vector<std::vector<size_t>> ensembles;
+    for (const auto& indices : particles) {
+        for (size_t first = 0; first < indices.size(); first += ensemble_size) {
+            const size_t last = std::min(first + ensemble_size, indices.size());
+            ensembles.emplace_back(indices.begin() + first, indices.begin() + last);
+        }
+    }
+
+    auto population_keys = [&](const std::vector<size_t>& indices) {
+        std::vector<std::vector<double>> keys;
+        for (auto i : indices) { keys.push_back(Population::synthesis_key(batch_parsets[i])); }
+        return keys;
+    };
+    std::stable_sort(ensembles.begin(), ensembles.end(), [&](const auto& a, const auto& b) {
+        return population_keys(a) < population_keys(b);
+    });
+    return ensembles;
+}
+
+/**
+ * @details Particles are sorted by their population synthesis parameters and seed
+ *          (see Population::synthesis_key), keeping batch order among equal keys.
+ *          Each particle still reports under its own serial.
+ */
+std::vector<size_t> Storyteller::population_order() const {
+    std::vector<std::vector<double>> keys;
+    for (const auto& parset : batch_parsets) { keys.push_back(Population::synthesis_key(parset)); }
+
+    std::vector<size_t> order(batch_parsets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+/**
+ * @details Every realization gets its own RngHandler (seeded with its own seed)
+ *          and, outside of the hpc mode, its own DatabaseHandler for its job. The
+ *          realizations share a single #parameters.
+ */
+void Storyteller::init_ensemble(const int serial_start, const std::vector<size_t>& indices) {
+    const bool hpc_mode = simulation_flags.at("hpc_mode");
+
+    std::vector<Ensemble::Realization> realizations;
+    for (auto index : indices) {
+        const size_t serial = serial_start + index;
+
+        ensemble_rng_handlers.push_back(std::make_unique<RngHandler>(RngHandler::backend_from_name(rng_backend)));
+        ensemble_rng_handlers.back()->set_seed(batch_parsets[index][SEED]);
+        ensemble_rng_handlers.back()->set_common_random_numbers(simulation_flags.at("crn"));
+
+        DatabaseHandler* dbh = nullptr;
+        if (hpc_mode) {
+            jobs[index].start();
+        } else {
+            ensemble_db_handlers.push_back(std::make_unique<DatabaseHandler>(this));
+            ensemble_db_handlers.back()->start_job(serial);
+            dbh = ensemble_db_handlers.back().get();
+        }
+        realizations.push_back({serial, ensemble_rng_handlers.back().get(), dbh});
+    }
+
+    const auto first = indices.front();
+    parameters = std::make_unique<Parameters>(ensemble_rng_handlers.front().get(), realizations.front().db_handler, tome.get());
+    parameters->read_parameters_from_batch(serial_start + first, batch_parsets[first]);
+    std::cerr << serial_start + first << " ensemble of " << indices.size() << " init ... ";
+
+    if (parameters->are_valid()) {
+        ensemble = std::make_unique<Ensemble>(parameters.get(), realizations, arena.get());
+        ensemble->set_flags(simulation_flags);
+        ensemble->set_population_cache(population_cache.get());
+        ensemble->set_checkpoint_interval(checkpoint_interval);
+        ensemble->set_synthpop(synthpop.get());
+        ensemble->init();
+        if (simulation_flags.at("resume")) { ensemble->resume(); }
+    } else {
+        std::cerr << "ERROR: invalid parameters\n";
+        exit(-1);
+    }
+}
+
+/**
+ * @details In the hpc mode this also creates the job of every particle in the
+ *          batch (see init_hpc_batch).
+ */
+void Storyteller::init_batch() {
+    if (simulation_flags.at("hpc_mode")) {
+        init_hpc_batch();
+    } else {
+        db_handler = std::make_unique<DatabaseHandler>(this);
+        const auto serial_start = simulation_serial;
+        const auto serial_end = serial_start + (batch_size - 1);
+        batch_parsets = db_handler->read_batch_parameters(serial_start, serial_end, tome->get_parameter_schema());
+    }
+}
 
 void Storyteller::init_hpc_batch() {
     db_handler = std::make_unique<DatabaseHandler>(this);
@@ -391,51 +956,68 @@ void Storyteller::init_hpc_batch() {
         jobs.emplace_back(serial);
     }
 
-    std::vector<std::string> par_names({"seed"});
-    sol::optional<sol::table> pars = tome->get_config_params().at("parameters").as<sol::table>();
-    if (pars) {
-        for (const auto& [key, obj] : pars.value()) {
-            auto fullname   = key.as<std::string>();
-            auto attributes = obj.as<sol::table>();
-            auto nickname   = attributes.get_or<std::string>("nickname", fullname);
-
-            par_names.push_back(nickname);
-        }
-    }
-
-    batch_parsets = db_handler->read_batch_parameters(serial_start, serial_end, par_names);
+    batch_parsets = db_handler->read_batch_parameters(serial_start, serial_end, tome->get_parameter_schema());
 }
 
 /**
- * @details Initializes the Storyteller appropriately for a simulation operation
- *          Parameter values are read from the appropriate particle in the
- *          experiment database and used to construct the #db_handler, #parameters
- *          and #rng_handler objects.
+ * @details Initializes the Storyteller for the simulation of a particle in the
+ *          batch (see init_batch). The #rng_handler, #parameters, and #simulator
+ *          are created for the first particle (see init_simulation_context) and
+ *          reset in place for every later one: the RngHandler is reseeded, the
+ *          parameter values are overwritten, and the Simulator reuses its
+ *          storage, so the cost of a particle scales with its simulation rather
+ *          than with object construction.
  */
 void Storyteller::init_simulation(const size_t index) {
-    rng_handler = std::make_unique<RngHandler>();
     if (simulation_flags.at("hpc_mode")) {
         jobs[index].start();
-        parameters = std::make_unique<Parameters>(rng_handler.get(), db_handler.get(), tome.get());
-        parameters->read_parameters_from_batch(simulation_serial, batch_parsets[index]);
         std::cerr << simulation_serial << " init ... ";
     } else {
-        db_handler = std::make_unique<DatabaseHandler>(this);
         db_handler->start_job(simulation_serial);
-        parameters = std::make_unique<Parameters>(rng_handler.get(), db_handler.get(), tome.get());
-        parameters->read_parameters_for_serial(simulation_serial);
     }
 
+    if (not simulator) { init_simulation_context(); }
+    parameters->read_parameters_from_batch(simulation_serial, batch_parsets[index]);
+
     if (parameters->are_valid()) {
-        simulator = std::make_unique<Simulator>(parameters.get(), db_handler.get(), rng_handler.get());
-        simulator->set_flags(simulation_flags);
+        simulator->reset();
         simulator->init();
+        if (simulation_flags.at("resume")) { simulator->resume(); }
     } else {
         std::cerr << "ERROR: invalid parameters\n";
         exit(-1);
     }
 }
 
+/**
+ * @details Creates the #rng_handler, #parameters, and #simulator that every
+ *          particle of the batch reuses. The Simulator is created with the
+ *          largest population and simulation duration in the batch, so that no
+ *          particle has to grow its storage.
+ */
+void Storyteller::init_simulation_context() {
+    ParameterSet largest = batch_parsets.front();
+    for (const auto& pars : batch_parsets) {
+        largest[POP_SIZE]     = std::max(largest[POP_SIZE], pars[POP_SIZE]);
+        largest[SIM_DURATION] = std::max(largest[SIM_DURATION], pars[SIM_DURATION]);
+    }
+
+    rng_handler = std::make_unique<RngHandler>(RngHandler::backend_from_name(rng_backend));
+    rng_handler->set_common_random_numbers(simulation_flags.at("crn"));
+    parameters = std::make_unique<Parameters>(rng_handler.get(), db_handler.get(), tome.get());
+    parameters->read_parameters_from_batch(simulation_serial, largest);
+
+    simulator = std::make_unique<Simulator>(parameters.get(), db_handler.get(), rng_handler.get(), arena.get());
+    simulator->set_flags(simulation_flags);
+    if (num_threads > 0) {
+        if (not thread_pool) thread_pool = std::make_unique<ThreadPool>(num_threads);
+        simulator->set_thread_pool(thread_pool.get());
+    }
+    simulator->set_population_cache(population_cache.get());
+    simulator->set_checkpoint_interval(checkpoint_interval);
+    simulator->set_synthpop(synthpop.get());
+}
+
 int Storyteller::construct_database() {
     // create the DatabaseHandler
     std::string db_path = tome->get_path("database");
@@ -447,7 +1029,11 @@ int Storyteller::construct_database() {
     } else {
         // construct the experiment database since it does not exist
         std::cerr << db_path << " does not exist. Initializing...\n";
-        return db_handler->init_database();
+        auto ret = db_handler->init_database();
+
+        // simulations load the compiled tome instead of running the Lua configs
+        if (ret == 0) tome->compile();
+        return ret;
     }
 }
 
@@ -489,11 +1075,17 @@ int Storyteller::cleanup_metrics_files() {
 /**
  * @details Deletes the current #simulator, #db_handler, #parameters, and
  *          #rng_handler objects after a simulation is finished so that they can
- *          be properly initialized for the next simulation in the batch.
+ *          be properly initialized for the next simulation in the batch. All of
+ *          the simulation's storage is then released at once by rewinding the
+ *          #arena, which keeps its memory for the next simulation.
  */
 void Storyteller::reset() {
     simulator.reset(nullptr);
+    ensemble.reset(nullptr);
+    arena->rewind();
     db_handler.reset(nullptr);
     rng_handler.reset(nullptr);
+    ensemble_db_handlers.clear();
+    ensemble_rng_handlers.clear();
     parameters.reset(nullptr);
 }
\ No newline at end of file
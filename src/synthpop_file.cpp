@@ -0,0 +1,188 @@
+/**
+ * @file synthpop_file.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the SynthpopFile class that writes synthesized populations to a
+ *        binary file and memory maps them back in place of synthesis.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <storyteller/synthpop_file.hpp>
+#include <storyteller/population.hpp>
+#include <storyteller/utility.hpp>
+#include <storyteller/checkpoint.hpp>
+
+namespace {
+
+constexpr size_t COLUMN_ALIGNMENT = 64;
+
+size_t align_up(size_t offset) { return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT; }
+
+} // namespace
+
+/**
+ * @details Maps the whole file read-only and checks that the header and columns
+ *          are intact, so that loading never reads past the mapping.
+ */
+SynthpopFile::SynthpopFile(const std::string& synthpop_path)
+    : path(synthpop_path),
+      mapping(nullptr),
+      n_bytes(0) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if ((fd < 0) or (fstat(fd, &file_stat) != 0)) {
+        std::cerr << "ERROR: could not open synthetic population " << path << '\n';
+        exit(-1);
+    }
+
+    n_bytes = file_stat.st_size;
+    if (n_bytes < sizeof(Header)) {
+        std::cerr << "ERROR: " << path << " is too small to be a synthetic population\n";
+        exit(-1);
+    }
+
+    void* addr = mmap(nullptr, n_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "ERROR: could not map synthetic population " << path << '\n';
+        exit(-1);
+    }
+    mapping = addr;
+
+    const auto& header = get_header();
+    if ((header.magic != Header::MAGIC) or (header.version != Header::VERSION)) {
+        std::cerr << "ERROR: " << path << " is not a version " << Header::VERSION << " synthetic population\n";
+        exit(-1);
+    }
+
+    // every agent takes at least a byte, which also keeps the column sizes from wrapping
+    if (header.pop_size > n_bytes) {
+        std::cerr << "ERROR: synthetic population " << path << " is truncated or corrupt\n";
+        exit(-1);
+    }
+
+    const size_t status_bytes = header.pop_size * sizeof(uint8_t);
+    const size_t value_bytes  = header.pop_size * sizeof(double);
+    for (size_t c = 0; c < Header::N_COLUMNS; ++c) {
+        // compared without adding to the offset, which a corrupt file could make wrap
+        const size_t column_offset = header.column_offsets[c];
+        const size_t column_bytes  = (c == 0) ? status_bytes : value_bytes;
+        const bool in_bounds = (column_offset <= n_bytes) and (column_bytes <= n_bytes - column_offset);
+        if ((column_offset % COLUMN_ALIGNMENT != 0) or not in_bounds) {
+            std::cerr << "ERROR: synthetic population " << path << " is truncated or corrupt\n";
+            exit(-1);
+        }
+    }
+}
+
+SynthpopFile::~SynthpopFile() {
+    if (mapping) munmap(const_cast<void*>(mapping), n_bytes);
+}
+
+const SynthpopFile::Header& SynthpopFile::get_header() const { return *static_cast<const Header*>(mapping); }
+
+template<typename T>
+const T* SynthpopFile::column(size_t c) const {
+    return reinterpret_cast<const T*>(static_cast<const char*>(mapping) + get_header().column_offsets[c]);
+}
+
+/**
+ * @details The file is a frozen population: it must have been generated with the
+ *          same population size and synthesis parameters as the simulation, but
+ *          may come from any seed (and simulation duration, which only sets the
+ *          vaccination time of the unvaccinated). Vaccination times are not
+ *          stored, since the vaccinated are all vaccinated at synthesis.
+ *
+ * @return size_t Number of vaccinated agents
+ */
+size_t SynthpopFile::load_into(Population& population, const std::vector<double>& key, size_t time) const {
+    const auto& header = get_header();
+    if (header.pop_size != population.size()) {
+        std::cerr << "ERROR: " << path << " has " << header.pop_size << " agents but the simulation has "
+                  << population.size() << '\n';
+        exit(-1);
+    }
+    for (size_t k = 0; k < Population::SYNTHESIS_PARAMETERS.size(); ++k) {
+        const auto id = Population::SYNTHESIS_PARAMETERS[k];
+        if ((id == SEED) or (id == SIM_DURATION)) { continue; }
+        if (header.parameters[k] != key[k]) {
+            std::cerr << "ERROR: " << path << " was generated with " << builtin_parameter_nicknames[id] << " = "
+                      << header.parameters[k] << " but the simulation has " << key[k] << '\n';
+            exit(-1);
+        }
+    }
+
+    const size_t pop_size = header.pop_size;
+    const auto status = column<uint8_t>(0);
+    for (size_t i = 0; i < pop_size; ++i) {
+        population.vaccination_status[i] = (VaccinationStatus) status[i];
+        if (status[i] == VACCINATED) { population.vaccination_time[i] = time; }
+    }
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        std::copy_n(column<double>(1 + s), pop_size, population.susceptibility[s].begin());
+        std::copy_n(column<double>(1 + NUM_STRAIN_TYPES + s), pop_size, population.vaccine_protection[s].begin());
+    }
+    return header.vaccinated;
+}
+
+void SynthpopFile::write(const std::string& path, const Population& population, const std::vector<double>& key,
+                         const RngHandler* rng_handler, size_t time) {
+    const size_t pop_size = population.size();
+
+    Header header = {};
+    header.magic                 = Header::MAGIC;
+    header.version               = Header::VERSION;
+    header.pop_size              = pop_size;
+    header.synthesis_time        = time;
+    header.vaccinated            = std::count(population.vaccination_status.begin(), population.vaccination_status.end(), VACCINATED);
+    header.rng_backend           = rng_handler->get_backend();
+    header.common_random_numbers = rng_handler->uses_common_random_numbers();
+    std::copy(key.begin(), key.end(), header.parameters);
+
+    size_t offset = align_up(sizeof(Header));
+    for (size_t c = 0; c < Header::N_COLUMNS; ++c) {
+        header.column_offsets[c] = offset;
+        offset = align_up(offset + pop_size * ((c == 0) ? sizeof(uint8_t) : sizeof(double)));
+    }
+
+    // processes may have the current file mapped, so it is only replaced (by a
+    // rename) once the new one is complete, as checkpoints are
+    checkpoint::Writer file(std::filesystem::absolute(path));
+    size_t position = 0;
+    auto write_bytes = [&](const void* data, size_t n) {
+        file.write_bytes(data, n);
+        position += n;
+    };
+    auto pad_to = [&](size_t next) {
+        static const char zeros[COLUMN_ALIGNMENT] = {};
+        write_bytes(zeros, next - position);
+    };
+
+    write_bytes(&header, sizeof(Header));
+
+    pad_to(header.column_offsets[0]);
+    std::vector<uint8_t> status(population.vaccination_status.begin(), population.vaccination_status.end());
+    write_bytes(status.data(), status.size());
+
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        pad_to(header.column_offsets[1 + s]);
+        write_bytes(population.susceptibility[s].data(), pop_size * sizeof(double));
+    }
+    for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+        pad_to(header.column_offsets[1 + NUM_STRAIN_TYPES + s]);
+        write_bytes(population.vaccine_protection[s].data(), pop_size * sizeof(double));
+    }
+    pad_to(offset);
+
+    file.commit();
+}
\ No newline at end of file
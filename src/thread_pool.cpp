@@ -0,0 +1,98 @@
+/**
+ * @file thread_pool.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the ThreadPool class that runs the chunked work of a simulation
+ *        tick across a fixed set of worker threads.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+
+#include <storyteller/thread_pool.hpp>
+
+ThreadPool::ThreadPool(size_t n)
+    : num_threads(std::max<size_t>(n, 1)),
+      current_task(nullptr),
+      n_current_tasks(0),
+      next_task(0),
+      n_finished(0),
+      generation(0),
+      stopping(false) {}
+
+ThreadPool::~ThreadPool() { shutdown(); }
+
+size_t ThreadPool::size() const { return num_threads; }
+
+void ThreadPool::start() {
+    workers.reserve(num_threads - 1);
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, generation);
+    }
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& w : workers) {
+        if (w.joinable()) w.join();
+    }
+    workers.clear();
+
+    // the pool can be lazily restarted by the next parallel_for
+    stopping = false;
+}
+
+void ThreadPool::parallel_for(size_t n_tasks, const std::function<void(size_t)>& task) {
+    if ((num_threads == 1) or (n_tasks <= 1)) {
+        for (size_t i = 0; i < n_tasks; ++i) { task(i); }
+        return;
+    }
+
+    if (workers.empty()) start();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        current_task    = &task;
+        n_current_tasks = n_tasks;
+        next_task       = 0;
+        n_finished      = 0;
+        ++generation;
+    }
+    work_cv.notify_all();
+
+    run_tasks();
+
+    // every worker must check in so none of them can see the next generation's
+    // task list while still working on this one
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this] { return n_finished == workers.size(); });
+    current_task = nullptr;
+}
+
+void ThreadPool::run_tasks() {
+    for (size_t i = next_task++; i < n_current_tasks; i = next_task++) {
+        (*current_task)(i);
+    }
+}
+
+void ThreadPool::worker_loop(size_t seen_generation) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            work_cv.wait(lock, [&] { return stopping or (generation != seen_generation); });
+            if (stopping) return;
+            seen_generation = generation;
+        }
+
+        run_tasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++n_finished;
+        }
+        done_cv.notify_one();
+    }
+}
\ No newline at end of file
@@ -6,6 +6,11 @@
  *
  * @copyright TBD
  */
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <map>
 #include <string>
 #include <filesystem>
@@ -14,9 +19,64 @@
 #include <sol/sol.hpp>
 
 #include <storyteller/tome.hpp>
+#include <storyteller/checkpoint.hpp>
 
 namespace fs = std::filesystem;
 
+namespace {
+
+constexpr uint32_t COMPILED_MAGIC   = 0x4d545453; // "STTM"
+constexpr uint32_t COMPILED_VERSION = 2;
+
+enum ElementType : uint8_t { BOOLEAN, NUMBER, STRING };
+
+/**
+ * @brief 64-bit FNV-1a hash of a byte range.
+ */
+uint64_t hash_bytes(const std::string& bytes, size_t n_bytes) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < n_bytes; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 0x100000001b3;
+    }
+    return hash;
+}
+
+/**
+ * @brief Contents of a file ("" if it cannot be read).
+ */
+std::string read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (not in) { return ""; }
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief 64-bit FNV-1a hash of a file's contents (0 if it cannot be read).
+ */
+uint64_t hash_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (not in) { return 0; }
+
+    const std::string contents(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>{});
+    return hash_bytes(contents, contents.size());
+}
+
+/**
+ * @brief Whether a compiled Tome ends with the checksum of everything before it,
+ *        ie, whether it was written completely and has not been damaged since.
+ */
+bool has_valid_checksum(const fs::path& path) {
+    const auto contents = read_file(path);
+    if (contents.size() < sizeof(uint64_t)) { return false; }
+
+    const size_t n_body = contents.size() - sizeof(uint64_t);
+    uint64_t checksum = 0;
+    std::memcpy(&checksum, contents.data() + n_body, sizeof(uint64_t));
+    return checksum == hash_bytes(contents, n_body);
+}
+
+} // namespace
+
 Tome::Tome(sol::state* lua_vm, std::string path)
     : vm(lua_vm),
       tome_path(path) {
@@ -49,6 +109,7 @@ Tome::Tome(sol::state* lua_vm, std::string path)
     }
 
     slurp_table(param_table.value(), config_params);
+    compile_parameter_schema();
 
     fs::path metrics_config_path = tome_path.parent_path();
     metrics_config_path /= config_core["metrics"].as<std::string>();
@@ -61,10 +122,178 @@ Tome::Tome(sol::state* lua_vm, std::string path)
     }
 
     slurp_table(metrics_table.value(), config_metrics);
+    for (const auto& [name, el] : config_metrics) { metric_names.push_back(name); }
 
     determine_paths();
 }
 
+/**
+ * @details Only the parts of a Tome that a simulation reads are restored, so no
+ *          Lua is run: each scalar core element is pushed into the (otherwise
+ *          empty) Lua state, the parameter schema is declared slot by slot, and
+ *          the paths are determined as usual.
+ */
+Tome::Tome(sol::state* lua_vm, std::string path, checkpoint::Reader& compiled)
+    : vm(lua_vm),
+      tome_path(path) {
+    uint64_t n_elements = 0;
+    compiled.read(n_elements);
+    for (uint64_t i = 0; i < n_elements; ++i) {
+        std::string key;
+        uint8_t element_type = 0;
+        compiled.read(key);
+        compiled.read(element_type);
+
+        if (element_type == BOOLEAN) {
+            uint8_t value = 0;
+            compiled.read(value);
+            config_core[key] = sol::make_object(vm->lua_state(), value != 0);
+        } else if (element_type == NUMBER) {
+            double value = 0.0;
+            compiled.read(value);
+            config_core[key] = (std::trunc(value) == value) ? sol::make_object(vm->lua_state(), (int64_t) value)
+                                                            : sol::make_object(vm->lua_state(), value);
+        } else {
+            std::string value;
+            compiled.read(value);
+            config_core[key] = sol::make_object(vm->lua_state(), value);
+        }
+        element_lookup[key] = &config_core;
+    }
+
+    std::vector<std::string> fullnames, nicknames, datatypes, flags;
+    compiled.read(fullnames);
+    compiled.read(nicknames);
+    compiled.read(datatypes);
+    compiled.read(flags);
+    for (size_t i = 0; i < fullnames.size(); ++i) {
+        parameter_schema.declare(fullnames[i], nicknames[i], datatypes[i], flags[i]);
+    }
+
+    compiled.read(metric_names);
+
+    determine_paths();
+}
+
+fs::path Tome::compiled_path(const fs::path& tome_path) {
+    fs::path path = tome_path;
+    path += ".compiled";
+    return path;
+}
+
+/**
+ * @details Returns null (ie, the Tome must be loaded from Lua) if there is no
+ *          compiled Tome, if it is truncated or damaged (its trailing checksum
+ *          does not match), if it was compiled by a different version of the
+ *          Storyteller, or if the tome or its parameter or metric config has
+ *          changed since it was compiled. The checksum is verified before
+ *          anything is parsed, so the (fatal) reads below cannot fail.
+ */
+std::unique_ptr<Tome> Tome::load_compiled(sol::state* lua_vm, std::string path) {
+    const auto compiled_tome = compiled_path(path);
+    if (not fs::exists(compiled_tome)) { return nullptr; }
+    if (not has_valid_checksum(compiled_tome)) { return nullptr; }
+
+    checkpoint::Reader in(compiled_tome);
+    uint32_t magic = 0, version = 0;
+    uint64_t n_builtin_parameters = 0;
+    in.read(magic);
+    in.read(version);
+    in.read(n_builtin_parameters);
+    if ((magic != COMPILED_MAGIC) or (version != COMPILED_VERSION)
+        or (n_builtin_parameters != NUM_BUILTIN_PARAMETERS)) {
+        return nullptr;
+    }
+
+    std::vector<std::string> sources;
+    std::vector<uint64_t> hashes;
+    in.read(sources);
+    in.read(hashes);
+    const auto config_dir = fs::path(path).parent_path();
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (hash_file(config_dir / sources[i]) != hashes[i]) { return nullptr; }
+    }
+
+    return std::unique_ptr<Tome>(new Tome(lua_vm, path, in));
+}
+
+/**
+ * @details Written next to the tome file (the database path is itself part of
+ *          the tome). Core elements that are not booleans, numbers, or strings
+ *          are not compiled.
+ */
+void Tome::compile() const {
+    const std::vector<std::string> sources = {
+        tome_path.filename().string(),
+        config_core.at("parameters").as<std::string>(),
+        config_core.at("metrics").as<std::string>()
+    };
+    std::vector<uint64_t> hashes;
+    for (const auto& source : sources) { hashes.push_back(hash_file(tome_path.parent_path() / source)); }
+
+    checkpoint::Writer out(compiled_path(fs::absolute(tome_path)));
+    out.write(COMPILED_MAGIC);
+    out.write(COMPILED_VERSION);
+    out.write((uint64_t) NUM_BUILTIN_PARAMETERS);
+    out.write(sources);
+    out.write(hashes);
+
+    uint64_t n_elements = 0;
+    for (const auto& [key, obj] : config_core) {
+        const auto t = obj.get_type();
+        n_elements += (t == sol::type::boolean) or (t == sol::type::number) or (t == sol::type::string);
+    }
+    out.write(n_elements);
+    for (const auto& [key, obj] : config_core) {
+        switch (obj.get_type()) {
+            case sol::type::boolean: {
+                out.write(key);
+                out.write((uint8_t) BOOLEAN);
+                out.write((uint8_t) obj.as<bool>());
+                break;
+            }
+            case sol::type::number: {
+                out.write(key);
+                out.write((uint8_t) NUMBER);
+                out.write(obj.as<double>());
+                break;
+            }
+            case sol::type::string: {
+                out.write(key);
+                out.write((uint8_t) STRING);
+                out.write(obj.as<std::string>());
+                break;
+            }
+            default: break;
+        }
+    }
+
+    // the seed is declared by every ParameterSchema, and the other built-in
+    // parameters keep their slots when declared again in slot order
+    std::vector<std::string> fullnames, nicknames, datatypes, flags;
+    for (size_t slot = 0; slot < parameter_schema.size(); ++slot) {
+        if ((slot == SEED) or (not parameter_schema.is_declared(slot))) { continue; }
+        fullnames.push_back(parameter_schema.get_fullname(slot));
+        nicknames.push_back(parameter_schema.get_nickname(slot));
+        datatypes.push_back(parameter_schema.get_datatype(slot));
+        flags.push_back(parameter_schema.get_flag(slot));
+    }
+    out.write(fullnames);
+    out.write(nicknames);
+    out.write(datatypes);
+    out.write(flags);
+
+    out.write(metric_names);
+    out.commit();
+
+    // the checksum is appended last, so an interrupted compile leaves a file that
+    // load_compiled rejects rather than one it cannot read
+    const auto path = compiled_path(fs::absolute(tome_path));
+    const uint64_t checksum = hash_file(path);
+    std::ofstream trailer(path, std::ios::binary | std::ios::app);
+    trailer.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+}
+
 std::map<std::string, sol::object> Tome::get_config_core()    const { return config_core; }
 std::map<std::string, sol::object> Tome::get_config_params()  const { return config_params; }
 std::map<std::string, sol::object> Tome::get_config_metrics() const { return config_metrics; }
@@ -74,8 +303,41 @@ sol::object Tome::get_element(std::string key) const {
     return dict->at(key);
 }
 
+bool Tome::has_element(std::string key) const { return element_lookup.count(key); }
+
 std::string Tome::get_path(std::string key) const { return paths.at(key); }
 
+const ParameterSchema* Tome::get_parameter_schema() const { return &parameter_schema; }
+const std::vector<std::string>& Tome::get_metric_names() const { return metric_names; }
+
+/**
+ * @details Calls the parameter's Lua `validate` function, so this must only be
+ *          called from the thread that owns the Lua state (ie, while initializing
+ *          the experiment database, never while simulating).
+ */
+bool Tome::validate_parameter(size_t slot, double value) const {
+    if ((slot >= validators.size()) or (not validators[slot].valid())) { return true; }
+    return validators[slot](value);
+}
+
+void Tome::compile_parameter_schema() {
+    sol::optional<sol::table> pars = config_params.at("parameters").as<sol::table>();
+    if (pars) {
+        for (const auto& [key, obj] : pars.value()) {
+            auto fullname   = key.as<std::string>();
+            auto attributes = obj.as<sol::table>();
+            auto nickname   = attributes.get_or<std::string>("nickname", fullname);
+            auto datatype   = attributes.get_or<std::string>("datatype", "double");
+            auto flag       = attributes.get_or<std::string>("flag", "");
+
+            auto slot = parameter_schema.declare(fullname, nickname, datatype, flag);
+            if (slot >= validators.size()) { validators.resize(slot + 1); }
+            auto validate = attributes.get<sol::optional<sol::protected_function>>("validate");
+            if (validate) { validators[slot] = validate.value(); }
+        }
+    }
+}
+
 void Tome::determine_paths() {
     fs::path tome_root = tome_path.is_absolute()
                              ? tome_path.parent_path()
@@ -92,7 +354,9 @@ void Tome::determine_paths() {
     paths["database"] = tome_root / db_path;
     paths["simvis"]   = tome_root / "simvis.out";
     paths["synthpop"] = tome_root / "synthpop.out";
+    paths["synthpop.bin"] = tome_root / "synthpop.bin";
     paths["linelist"] = tome_root / "linelist.out";
+    paths["checkpoints"] = tome_root / "checkpoints";
     paths["scripts"]  = storyteller_root / "scripts";
     paths["simvis.R"] = paths.at("scripts") / "simvis.R";
     paths["slurp.R"] = paths.at("scripts") / "slurp_metrics_into_db.R";
@@ -128,5 +392,6 @@ void Tome::clean() {
     config_params.clear();
     config_metrics.clear();
     element_lookup.clear();
+    validators.clear();
     vm->collect_garbage();
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+/**
+ * @file transmission_kernel.cpp
+ * @author Alexander N. Pillai
+ * @brief Contains the vectorized kernel that decides the outcome of a batch of
+ *        exposures and the runtime selection of its instruction set.
+ *
+ * @copyright TBD
+ */
+#include <cstring>
+
+#include <storyteller/transmission_kernel.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STORYTELLER_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace transmission_kernel {
+    namespace {
+        inline uint8_t outcome(bool infected, bool symptoms, bool care) {
+            return (infected ? INFECTED : 0) | (symptoms ? HAS_SYMPTOMS : 0) | ((symptoms and care) ? SEEKS_CARE : 0);
+        }
+
+        void evaluate_scalar(const InfectionBatch& b, size_t first) {
+            for (size_t i = first; i < b.n; ++i) {
+                const double pr_infection = b.susceptibility[i] * (1 - b.vaccine_protection[i]);
+                b.outcomes[i] = outcome(b.u_infection[i] < pr_infection,
+                                        b.u_symptoms[i] < b.pr_symptoms[i],
+                                        b.u_careseeking[i] < b.pr_careseeking[i]);
+            }
+        }
+
+#ifdef STORYTELLER_X86_KERNELS
+        __attribute__((target("avx2,bmi2")))
+        void evaluate_avx2(const InfectionBatch& b) {
+            const __m256d one = _mm256_set1_pd(1.0);
+            size_t i = 0;
+            for (; i + 4 <= b.n; i += 4) {
+                const __m256d protection   = _mm256_sub_pd(one, _mm256_loadu_pd(b.vaccine_protection + i));
+                const __m256d pr_infection = _mm256_mul_pd(_mm256_loadu_pd(b.susceptibility + i), protection);
+
+                const unsigned infected = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(b.u_infection + i), pr_infection, _CMP_LT_OQ));
+                const unsigned symptoms = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(b.u_symptoms + i), _mm256_loadu_pd(b.pr_symptoms + i), _CMP_LT_OQ));
+                const unsigned care     = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(b.u_careseeking + i), _mm256_loadu_pd(b.pr_careseeking + i), _CMP_LT_OQ));
+
+                // spread each lane's bit into its own outcome byte
+                const uint32_t bytes = _pdep_u32(infected, 0x01010101)
+                                     | _pdep_u32(symptoms, 0x02020202)
+                                     | _pdep_u32(symptoms & care, 0x04040404);
+                std::memcpy(b.outcomes + i, &bytes, sizeof(bytes));
+            }
+            evaluate_scalar(b, i);
+        }
+
+        __attribute__((target("avx512f,bmi2")))
+        void evaluate_avx512(const InfectionBatch& b) {
+            const __m512d one = _mm512_set1_pd(1.0);
+            size_t i = 0;
+            for (; i + 8 <= b.n; i += 8) {
+                const __m512d protection   = _mm512_sub_pd(one, _mm512_loadu_pd(b.vaccine_protection + i));
+                const __m512d pr_infection = _mm512_mul_pd(_mm512_loadu_pd(b.susceptibility + i), protection);
+
+                const __mmask8 infected = _mm512_cmp_pd_mask(_mm512_loadu_pd(b.u_infection + i), pr_infection, _CMP_LT_OQ);
+                const __mmask8 symptoms = _mm512_cmp_pd_mask(_mm512_loadu_pd(b.u_symptoms + i), _mm512_loadu_pd(b.pr_symptoms + i), _CMP_LT_OQ);
+                const __mmask8 care     = _mm512_cmp_pd_mask(_mm512_loadu_pd(b.u_careseeking + i), _mm512_loadu_pd(b.pr_careseeking + i), _CMP_LT_OQ);
+
+                // spread each lane's bit into its own outcome byte
+                const uint64_t bytes = _pdep_u64(infected, 0x0101010101010101ULL)
+                                     | _pdep_u64(symptoms, 0x0202020202020202ULL)
+                                     | _pdep_u64(symptoms & care, 0x0404040404040404ULL);
+                std::memcpy(b.outcomes + i, &bytes, sizeof(bytes));
+            }
+            evaluate_scalar(b, i);
+        }
+#endif
+
+        KernelIsa detect_isa() {
+#ifdef STORYTELLER_X86_KERNELS
+            __builtin_cpu_init();
+            if (not __builtin_cpu_supports("bmi2")) { return SCALAR; }
+            if (__builtin_cpu_supports("avx512f")) { return AVX512; }
+            if (__builtin_cpu_supports("avx2")) { return AVX2; }
+#endif
+            return SCALAR;
+        }
+    }
+
+    KernelIsa best_isa() {
+        static const KernelIsa isa = detect_isa();
+        return isa;
+    }
+
+    bool is_supported(KernelIsa isa) { return isa <= best_isa(); }
+
+    const char* isa_name(KernelIsa isa) {
+        switch (isa) {
+            case AVX512: { return "avx512"; }
+            case AVX2:   { return "avx2"; }
+            default:     { return "scalar"; }
+        }
+    }
+
+    void evaluate(const InfectionBatch& batch) { evaluate(batch, best_isa()); }
+
+    void evaluate(const InfectionBatch& batch, KernelIsa isa) {
+        switch (isa) {
+#ifdef STORYTELLER_X86_KERNELS
+            case AVX512: { evaluate_avx512(batch); break; }
+            case AVX2:   { evaluate_avx2(batch); break; }
+#endif
+            default:     { evaluate_scalar(batch, 0); break; }
+        }
+    }
+}
\ No newline at end of file
@@ -8,9 +8,16 @@
  */
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
 
 
+#include <gsl/gsl_randist.h>
+
 #include <storyteller/utility.hpp>
+#include <storyteller/philox.hpp>
+#include <storyteller/checkpoint.hpp>
 #include <storyteller/simulator.hpp>
 #include <storyteller/storyteller.hpp>
 
@@ -79,12 +86,25 @@ namespace util {
     double exp_decay(const double rate, const double time) {
         return std::exp(-1 * rate * time);
     }
+
+    // splitmix64 finalizer applied to each coordinate in turn
+    unsigned long int mix_seed(unsigned long int seed, size_t a, size_t b, size_t c) {
+        auto mix = [](uint64_t z) {
+            z += 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        };
+        return mix(mix(mix(mix(seed) ^ a) ^ b) ^ c);
+    }
 }
 
-RngHandler::RngHandler() {
-    infection_rng   = gsl_rng_alloc(gsl_rng_mt19937);
-    vaccination_rng = gsl_rng_alloc(gsl_rng_mt19937);
-    behavior_rng    = gsl_rng_alloc(gsl_rng_mt19937);
+RngHandler::RngHandler(RngBackend rng_backend)
+    : backend(rng_backend),
+      common_random_numbers(false) {
+    infection_rng   = gsl_rng_alloc(get_backend_type());
+    vaccination_rng = gsl_rng_alloc(get_backend_type());
+    behavior_rng    = gsl_rng_alloc(get_backend_type());
 }
 
 RngHandler::~RngHandler() {
@@ -118,4 +138,134 @@ gsl_rng* RngHandler::get_rng(RngType type) const {
     }
 }
 
+void RngHandler::fill_uniform(RngType type, double* out, size_t n) const { fill_uniform(get_rng(type), out, n); }
+
+void RngHandler::fill_gaussian(RngType type, double* out, size_t n, double sigma) const {
+    fill_gaussian(get_rng(type), out, n, sigma);
+}
+
+void RngHandler::fill_beta(RngType type, double* out, size_t n, double a, double b) const {
+    fill_beta(get_rng(type), out, n, a, b);
+}
+
+/**
+ * @details Philox streams generate whole blocks straight into the buffer; any
+ *          other generator falls back to one gsl_rng_uniform call per value.
+ *          Either way the values are exactly those of n single draws.
+ */
+void RngHandler::fill_uniform(gsl_rng* r, double* out, size_t n) {
+    if (r->type == gsl_rng_philox4x32) {
+        philox::fill_uniform(static_cast<philox::State*>(r->state), out, n);
+    } else {
+        for (size_t i = 0; i < n; ++i) { out[i] = gsl_rng_uniform(r); }
+    }
+}
+
+/**
+ * @details Philox streams use a Box-Muller transform of bulk uniforms, two
+ *          normals per pair of draws; any other generator falls back to one
+ *          gsl_ran_gaussian call per value.
+ */
+void RngHandler::fill_gaussian(gsl_rng* r, double* out, size_t n, double sigma) {
+    if (r->type != gsl_rng_philox4x32) {
+        for (size_t i = 0; i < n; ++i) { out[i] = gsl_ran_gaussian(r, sigma); }
+        return;
+    }
+
+    const size_t n_pairs = (n + 1) / 2;
+    std::vector<double> u(2 * n_pairs);
+    fill_uniform(r, u.data(), u.size());
+
+    for (size_t i = 0; i < n_pairs; ++i) {
+        // 1 - u is in (0, 1] so the log is always finite
+        const double radius = sigma * std::sqrt(-2.0 * std::log(1.0 - u[2 * i]));
+        const double theta  = 2.0 * constants::PI * u[2 * i + 1];
+        out[2 * i] = radius * std::cos(theta);
+        if (2 * i + 1 < n) { out[2 * i + 1] = radius * std::sin(theta); }
+    }
+}
+
+void RngHandler::fill_beta(gsl_rng* r, double* out, size_t n, double a, double b) {
+    for (size_t i = 0; i < n; ++i) { out[i] = gsl_ran_beta(r, a, b); }
+}
+
+RngBackend RngHandler::backend_from_name(const std::string& name) {
+    if (name == "philox") { return PHILOX; }
+    if (name == "mt19937") { return MT19937; }
+    std::cerr << "ERROR: unknown rng backend " << name << " (expected philox or mt19937)\n";
+    exit(-1);
+}
+
+RngBackend RngHandler::get_backend() const { return backend; }
+
+/**
+ * @details Writes the raw state of each of the three generators. Streams that are
+ *          reseeded from (seed, purpose, time, chunk) before every use, and keyed
+ *          draws, carry no state between days and are not written.
+ */
+void RngHandler::save_state(checkpoint::Writer& out) const {
+    for (auto r : {infection_rng, vaccination_rng, behavior_rng}) {
+        out.write(gsl_rng_size(r));
+        out.write_bytes(gsl_rng_state(r), gsl_rng_size(r));
+    }
+}
+
+/**
+ * @details Like every draw, restoring the generators' states does not change the
+ *          handler's configuration, so it is allowed through a const handler.
+ */
+void RngHandler::load_state(checkpoint::Reader& in) const {
+    for (auto r : {infection_rng, vaccination_rng, behavior_rng}) {
+        size_t n_bytes = 0;
+        in.read(n_bytes);
+        if (n_bytes != gsl_rng_size(r)) {
+            std::cerr << "ERROR: checkpointed rng state has " << n_bytes << " bytes but "
+                      << gsl_rng_name(r) << " expects " << gsl_rng_size(r) << '\n';
+            exit(-1);
+        }
+        in.read_bytes(gsl_rng_state(r), n_bytes);
+    }
+}
+
+const gsl_rng_type* RngHandler::get_backend_type() const {
+    return (backend == MT19937) ? gsl_rng_mt19937 : gsl_rng_philox4x32;
+}
+
+/**
+ * @details Reseeds the provided generator with a seed derived from the simulation
+ *          seed and the (purpose, time, chunk) coordinates, so that the numbers
+ *          drawn for a chunk of the population on a given day do not depend on
+ *          which thread draws them or on how many threads there are. The purpose
+ *          keeps streams for different stages (eg, population synthesis and
+ *          transmission) on the same day and chunk independent.
+ */
+void RngHandler::seed_stream(gsl_rng* stream, RngType purpose, size_t time, size_t chunk) const {
+    gsl_rng_set(stream, util::mix_seed(rng_seed, purpose, time, chunk));
+}
+
+/**
+ * @details In the common random numbers mode every random decision about an agent
+ *          is a pure function of (seed, agent, day, purpose) rather than a position
+ *          in a shared stream, so particles that share a seed see the same
+ *          randomness for each agent whatever their other parameter values are.
+ */
+void RngHandler::set_common_random_numbers(bool crn) { common_random_numbers = crn; }
+bool RngHandler::uses_common_random_numbers() const { return common_random_numbers; }
+
+/**
+ * @details The Philox block for counter (agent, day, block) under the seed, as
+ *          four uniforms in (0, 1) (see CrnDraw for which draw is in which lane).
+ *          Keyed draws always use Philox, whichever backend the streams use.
+ */
+std::array<double, 4> RngHandler::keyed_block(size_t agent, size_t day, size_t block) const {
+    const uint64_t agent64 = agent;
+    const uint64_t seed64  = rng_seed;
+    const auto b = philox::block({(uint32_t) agent64, (uint32_t) (agent64 >> 32), (uint32_t) day, (uint32_t) block},
+                                 {(uint32_t) seed64, (uint32_t) (seed64 >> 32)});
+
+    // centered in each 2^-32 interval so that quantile functions never see 0 or 1
+    constexpr double TO_UNIT = 1.0 / 4294967296.0;
+    return {(b[0] + 0.5) * TO_UNIT, (b[1] + 0.5) * TO_UNIT, (b[2] + 0.5) * TO_UNIT, (b[3] + 0.5) * TO_UNIT};
+}
+
 unsigned long int RngHandler::get_seed() const { return rng_seed; }
\ No newline at end of file
@@ -0,0 +1,110 @@
+/**
+ * @file crn_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests that particles sharing a seed share their keyed random draws in
+ *        the common random numbers mode.
+ *
+ * @copyright TBD
+ */
+#include <map>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/simulator.hpp>
+#include <storyteller/population.hpp>
+#include <storyteller/person.hpp>
+#include <storyteller/utility.hpp>
+
+#include "example_tome.hpp"
+
+namespace {
+
+const double PARTICLE_SEED = 7;
+
+/**
+ * @brief A particle simulated in the common random numbers mode.
+ */
+struct Particle {
+    Particle(const Tome* tome, double flu_vax_effect_mean)
+        : par(&rng_handler, nullptr, tome) {
+        par.read_default_parameters({{"pop_size", 2000}, {"sim_duration", 200}, {"seed", PARTICLE_SEED},
+                                     {"flu_vax_effect_is_contin", 1}, {"flu_vax_effect_mean", flu_vax_effect_mean}});
+        rng_handler.set_common_random_numbers(true);
+        simulator = std::make_unique<Simulator>(&par, nullptr, &rng_handler);
+        simulator->init();
+        simulator->simulate();
+    }
+
+    RngHandler rng_handler;
+    Parameters par;
+    std::unique_ptr<Simulator> simulator;
+};
+
+} // namespace
+
+TEST(CrnTest, KeyedDrawsOnlyDependOnSeedAgentDayAndPurpose) {
+    ExampleTome example("crn_keyed");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    const Particle low(&tome, 0.3), high(&tome, 0.8);
+    ASSERT_NE(low.par.get(FLU_VAX_EFFECT_MEAN), high.par.get(FLU_VAX_EFFECT_MEAN));
+
+    RngHandler other_seed;
+    other_seed.set_seed(PARTICLE_SEED + 1);
+    for (size_t agent = 0; agent < 100; ++agent) {
+        for (size_t day = 0; day < 10; ++day) {
+            for (size_t block = 0; block < NUM_CRN_DRAWS / 4; ++block) {
+                EXPECT_EQ(low.rng_handler.keyed_block(agent, day, block), high.rng_handler.keyed_block(agent, day, block));
+                EXPECT_NE(low.rng_handler.keyed_block(agent, day, block), other_seed.keyed_block(agent, day, block));
+            }
+        }
+    }
+}
+
+// the vaccine effect only changes the protection of vaccinated agents; every
+// agent's vaccination and susceptibility draws are shared, and so are the
+// exposure, infection, and symptom draws that decide an unvaccinated agent's
+// infections (exposure does not depend on anyone else's infections)
+TEST(CrnTest, ParticlesDifferingInVaccineEffectShareTheirDraws) {
+    ExampleTome example("crn_particles");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    Particle low(&tome, 0.3), high(&tome, 0.8);
+    auto low_pop  = low.simulator->get_population();
+    auto high_pop = high.simulator->get_population();
+    ASSERT_EQ(low_pop->size(), high_pop->size());
+
+    size_t n_unvaccinated_infections = 0;
+    size_t n_different_protections   = 0;
+    for (size_t i = 0; i < low_pop->size(); ++i) {
+        const auto a = (*low_pop)[i];
+        const auto b = (*high_pop)[i];
+        ASSERT_EQ(a.is_vaccinated(), b.is_vaccinated()) << "agent " << i;
+
+        for (size_t s = 0; s < NUM_STRAIN_TYPES; ++s) {
+            const auto strain = (StrainType) s;
+            EXPECT_EQ(a.get_susceptibility(strain), b.get_susceptibility(strain)) << "agent " << i;
+            if (a.is_vaccinated()) {
+                n_different_protections += (a.get_vaccine_protection(strain) != b.get_vaccine_protection(strain));
+                continue;
+            }
+
+            EXPECT_EQ(a.infection_count(strain), b.infection_count(strain)) << "agent " << i;
+            if (a.infection_count(strain) > 0) {
+                EXPECT_EQ(a.last_infection_time(strain), b.last_infection_time(strain)) << "agent " << i;
+                ++n_unvaccinated_infections;
+            }
+        }
+    }
+    EXPECT_GT(n_unvaccinated_infections, size_t(0));
+    EXPECT_GT(n_different_protections, size_t(0));
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+/**
+ * @file example_tome.hpp
+ * @author Alexander N. Pillai
+ * @brief Contains the ExampleTome that gives a test its own copy of the default
+ *        example's tome.
+ *
+ * @copyright TBD
+ */
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+/**
+ * @brief Copy of examples/default (tome and config) in a fresh temporary
+ *        directory, so that the outputs and checkpoints a test writes next to the
+ *        tome never land in the source tree. The directory is removed with the
+ *        object.
+ */
+class ExampleTome {
+  public:
+    explicit ExampleTome(const std::string& name)
+        : root(std::filesystem::temp_directory_path() /
+               ("storyteller_" + name + "_" + std::to_string(getpid()))) {
+        const std::filesystem::path example = STORYTELLER_EXAMPLE_TOME;
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root);
+        std::filesystem::copy_file(example, root / "tome.lua");
+        std::filesystem::copy(example.parent_path() / "config", root / "config",
+                              std::filesystem::copy_options::recursive);
+    }
+    ~ExampleTome() { std::filesystem::remove_all(root); }
+
+    std::string path() const { return (root / "tome.lua").string(); }
+    std::filesystem::path dir() const { return root; }
+
+    // contents of a file the test wrote next to the tome ("" if there is none)
+    std::string read(const std::filesystem::path& relative) const {
+        std::ifstream in(root / relative);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+  private:
+    std::filesystem::path root;
+};
\ No newline at end of file
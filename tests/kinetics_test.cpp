@@ -0,0 +1,115 @@
+/**
+ * @file kinetics_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests the Kinetics waning tables against the closed-form expressions
+ *        that Person evaluated before the tables.
+ *
+ * @copyright TBD
+ */
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/kinetics.hpp>
+#include <storyteller/utility.hpp>
+
+#include "example_tome.hpp"
+
+namespace {
+
+const std::map<StrainType, std::string> STRAIN_PREFIX = {{INFLUENZA, "flu_"}, {NON_INFLUENZA, "nonflu_"}};
+
+// susceptibility multiplier of Person::get_current_susceptibility before Kinetics
+double closed_form_immunity(double half_life, double refractory_period, size_t time, size_t infection_time) {
+    const auto waning_rate         = util::exp_decay_rate_from_half_life(half_life);
+    const auto time_since_last_inf = time - (infection_time + refractory_period);
+    return 1 - util::exp_decay(waning_rate, time_since_last_inf);
+}
+
+// protection multiplier of Person::get_remaining_vaccine_protection before Kinetics
+double closed_form_vaccine(double half_life, double waning_lag, size_t time, size_t vaccination_time) {
+    const auto waning_rate    = util::exp_decay_rate_from_half_life(half_life);
+    const auto time_since_vax = time - (vaccination_time + waning_lag);
+    return (time_since_vax < 0) ? 1.0 : util::exp_decay(waning_rate, time_since_vax);
+}
+
+/**
+ * @brief Largest difference between the Kinetics multipliers and the closed
+ *        forms over every (event day, current day) pair of a simulation, for
+ *        both strains.
+ *
+ * Immunity multipliers are only compared once the refractory period is over,
+ * since earlier ones are never used.
+ */
+double max_multiplier_error(const Tome* tome, std::map<std::string, double> overrides) {
+    overrides["sim_duration"] = 730;
+    for (const auto& [strain, prefix] : STRAIN_PREFIX) {
+        overrides[prefix + "inf_gen_immunity"]  = 1;
+        overrides[prefix + "inf_immunity_wanes"] = 1;
+        overrides[prefix + "vax_effect_wanes"]   = 1;
+    }
+
+    RngHandler rng_handler;
+    Parameters par(&rng_handler, nullptr, tome);
+    par.read_default_parameters(overrides);
+    const auto kinetics = par.get_kinetics();
+    const size_t sim_duration = par.get(SIM_DURATION);
+
+    double max_error = 0.0;
+    for (const auto& [strain, prefix] : STRAIN_PREFIX) {
+        const auto immunity_half_life = overrides.at(prefix + "inf_immunity_half_life");
+        const auto refractory_period  = overrides.at(prefix + "inf_refract_len");
+        const auto vax_half_life      = overrides.at(prefix + "vax_effect_half_life");
+        const auto vax_waning_lag     = overrides.at(prefix + "vax_effect_lag_til_waning");
+
+        for (size_t event = 0; event < sim_duration; ++event) {
+            for (size_t time = event; time < sim_duration; ++time) {
+                if (time - event >= refractory_period) {
+                    const auto expected = closed_form_immunity(immunity_half_life, refractory_period, time, event);
+                    const auto table    = kinetics->immunity_multiplier(strain, time, event);
+                    max_error = std::max(max_error, std::abs(table - expected));
+                }
+
+                const auto expected = closed_form_vaccine(vax_half_life, vax_waning_lag, time, event);
+                const auto table    = kinetics->vaccine_multiplier(strain, time, event);
+                max_error = std::max(max_error, std::abs(table - expected));
+            }
+        }
+    }
+    return max_error;
+}
+
+} // namespace
+
+TEST(KineticsTest, WholeDayParametersMatchClosedFormsExactly) {
+    ExampleTome example("kinetics_whole");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    EXPECT_EQ(max_multiplier_error(&tome, {{"flu_inf_immunity_half_life", 90},    {"nonflu_inf_immunity_half_life", 14},
+                                           {"flu_inf_refract_len", 5},            {"nonflu_inf_refract_len", 10},
+                                           {"flu_vax_effect_half_life", 200},     {"nonflu_vax_effect_half_life", 120},
+                                           {"flu_vax_effect_lag_til_waning", 7},  {"nonflu_vax_effect_lag_til_waning", 30}}),
+              0.0);
+}
+
+// strains with fractional lags or refractory periods evaluate the closed forms
+TEST(KineticsTest, FractionalParametersMatchClosedFormsExactly) {
+    ExampleTome example("kinetics_fractional");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    EXPECT_EQ(max_multiplier_error(&tome, {{"flu_inf_immunity_half_life", 90.5},     {"nonflu_inf_immunity_half_life", 1},
+                                           {"flu_inf_refract_len", 2.5},             {"nonflu_inf_refract_len", 4.75},
+                                           {"flu_vax_effect_half_life", 200},        {"nonflu_vax_effect_half_life", 1.5},
+                                           {"flu_vax_effect_lag_til_waning", 0.01},  {"nonflu_vax_effect_lag_til_waning", 10.37}}),
+              0.0);
+}
\ No newline at end of file
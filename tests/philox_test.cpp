@@ -0,0 +1,82 @@
+/**
+ * @file philox_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests the Philox4x32-10 generator against the Random123 known-answer
+ *        vectors, and the bulk fills of the RngHandler against single GSL draws.
+ *
+ * @copyright TBD
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+#include <storyteller/philox.hpp>
+#include <storyteller/utility.hpp>
+
+namespace {
+
+// buffer sizes around the generator's 4-value blocks and 8-block batches
+const std::vector<size_t> FILL_SIZES = {0, 1, 3, 4, 5, 31, 32, 33, 1000};
+
+} // namespace
+
+// kat_vectors of Random123 1.14 (philox4x32, 10 rounds)
+TEST(PhiloxTest, MatchesRandom123KnownAnswers) {
+    EXPECT_EQ(philox::block({0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0x00000000, 0x00000000}),
+              (philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(philox::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(philox::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+// the fill must also pick up where single draws left off, part way through a block
+TEST(PhiloxTest, FillUniformMatchesSingleDraws) {
+    for (size_t offset = 0; offset < 4; ++offset) {
+        for (auto n : FILL_SIZES) {
+            gsl_rng* single = gsl_rng_alloc(gsl_rng_philox4x32);
+            gsl_rng* bulk   = gsl_rng_alloc(gsl_rng_philox4x32);
+            gsl_rng_set(single, 2024);
+            gsl_rng_set(bulk, 2024);
+            for (size_t i = 0; i < offset; ++i) {
+                gsl_rng_uniform(single);
+                gsl_rng_uniform(bulk);
+            }
+
+            std::vector<double> expected(n), filled(n);
+            for (auto& u : expected) { u = gsl_rng_uniform(single); }
+            RngHandler::fill_uniform(bulk, filled.data(), n);
+            EXPECT_EQ(filled, expected) << "offset " << offset << ", n " << n;
+
+            // and leave the stream where the single draws did
+            EXPECT_EQ(gsl_rng_uniform(bulk), gsl_rng_uniform(single)) << "offset " << offset << ", n " << n;
+
+            gsl_rng_free(single);
+            gsl_rng_free(bulk);
+        }
+    }
+}
+
+TEST(PhiloxTest, Mt19937FillsMatchSingleDraws) {
+    for (auto n : FILL_SIZES) {
+        gsl_rng* single = gsl_rng_alloc(gsl_rng_mt19937);
+        gsl_rng* bulk   = gsl_rng_alloc(gsl_rng_mt19937);
+        gsl_rng_set(single, 2024);
+        gsl_rng_set(bulk, 2024);
+
+        std::vector<double> expected(n), filled(n);
+        for (auto& u : expected) { u = gsl_rng_uniform(single); }
+        RngHandler::fill_uniform(bulk, filled.data(), n);
+        EXPECT_EQ(filled, expected) << "uniform, n " << n;
+
+        for (auto& z : expected) { z = gsl_ran_gaussian(single, 0.5); }
+        RngHandler::fill_gaussian(bulk, filled.data(), n, 0.5);
+        EXPECT_EQ(filled, expected) << "gaussian, n " << n;
+
+        gsl_rng_free(single);
+        gsl_rng_free(bulk);
+    }
+}
\ No newline at end of file
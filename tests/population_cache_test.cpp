@@ -0,0 +1,74 @@
+/**
+ * @file population_cache_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests that the realizations of an ensemble each synthesize (or restore)
+ *        their own population when a PopulationCache is shared between them.
+ *
+ * @copyright TBD
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/ensemble.hpp>
+#include <storyteller/population_cache.hpp>
+#include <storyteller/utility.hpp>
+
+#include "example_tome.hpp"
+
+namespace {
+
+const std::vector<unsigned long int> SEEDS = {1, 2};
+
+// metrics csv of every realization of an ensemble of SEEDS (serial = index),
+// which share the Parameters of the first, as Storyteller::init_ensemble does
+std::vector<std::string> simulate_ensemble(const ExampleTome& example, const Tome* tome, PopulationCache* cache) {
+    std::vector<std::unique_ptr<RngHandler>> rng_handlers;
+    std::vector<Ensemble::Realization> realizations;
+    for (size_t r = 0; r < SEEDS.size(); ++r) {
+        rng_handlers.push_back(std::make_unique<RngHandler>());
+        rng_handlers.back()->set_seed(SEEDS[r]);
+        realizations.push_back({r, rng_handlers.back().get(), nullptr});
+    }
+
+    Parameters par(rng_handlers.front().get(), nullptr, tome);
+    par.read_default_parameters({{"pop_size", 2000}, {"sim_duration", 120}, {"seed", (double) SEEDS.front()}});
+
+    Ensemble ensemble(&par, realizations);
+    ensemble.set_flags({{"simulate", true}, {"hpc_mode", true}});
+    ensemble.set_population_cache(cache);
+    ensemble.init();
+    ensemble.simulate();
+    ensemble.results();
+
+    std::vector<std::string> metrics;
+    for (size_t r = 0; r < SEEDS.size(); ++r) {
+        metrics.push_back(example.read(std::filesystem::path("out") / ("metrics_" + std::to_string(r) + ".csv")));
+    }
+    return metrics;
+}
+
+} // namespace
+
+TEST(PopulationCacheTest, EnsembleRealizationsKeepTheirOwnSeeds) {
+    ExampleTome example("population_cache");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    const auto fresh = simulate_ensemble(example, &tome, nullptr);
+    ASSERT_FALSE(fresh[0].empty());
+
+    // the first ensemble synthesizes one population per seed, the second restores them
+    PopulationCache cache(SEEDS.size());
+    EXPECT_EQ(simulate_ensemble(example, &tome, &cache), fresh);
+    EXPECT_EQ(cache.get_misses(), SEEDS.size());
+    EXPECT_EQ(simulate_ensemble(example, &tome, &cache), fresh);
+    EXPECT_EQ(cache.get_hits(), SEEDS.size());
+}
\ No newline at end of file
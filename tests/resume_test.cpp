@@ -0,0 +1,245 @@
+/**
+ * @file resume_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests that simulations resumed from a checkpoint (periodic or written on
+ *        SIGTERM) produce the same results as uninterrupted ones, in the serial,
+ *        ensemble, and batch worker paths.
+ *
+ * @copyright TBD
+ */
+#include <csignal>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+#include <storyteller/parameters.hpp>
+#include <storyteller/simulator.hpp>
+#include <storyteller/ensemble.hpp>
+#include <storyteller/batch_worker.hpp>
+#include <storyteller/storyteller.hpp>
+#include <storyteller/database_handler.hpp>
+#include <storyteller/checkpoint.hpp>
+#include <storyteller/ledger.hpp>
+#include <storyteller/utility.hpp>
+
+#include "example_tome.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::map<std::string, double> PARAMETERS = {{"pop_size", 2000}, {"sim_duration", 120}, {"seed", 1}};
+const std::vector<unsigned long int> SEEDS = {1, 2};
+const size_t CHECKPOINT_INTERVAL = 50;
+
+const std::map<std::string, bool> FLAGS = {{"simulate", true}, {"hpc_mode", true}};
+
+fs::path checkpoint_file(const ExampleTome& example, size_t serial) {
+    return example.dir() / "checkpoints" / ("checkpoint_" + std::to_string(serial) + ".bin");
+}
+
+std::string metrics_csv(const ExampleTome& example, size_t serial) {
+    return example.read(fs::path("out") / ("metrics_" + std::to_string(serial) + ".csv"));
+}
+
+// every daily metric and total of a Ledger whose results were calculated
+std::string ledger_summary(const Ledger* ledger, size_t n_days) {
+    std::stringstream summary;
+    for (size_t t = 0; t < n_days; ++t) {
+        for (auto vaxd : {UNVACCINATED, VACCINATED}) {
+            for (auto strain : {NON_INFLUENZA, INFLUENZA}) {
+                summary << ledger->get_cumul_infs(vaxd, strain, t) << ','
+                        << ledger->get_cumul_sympt_infs(vaxd, strain, t) << ','
+                        << ledger->get_cumul_mais(vaxd, strain, t) << ',';
+            }
+        }
+        summary << ledger->get_tnd_ve_est(t) << '\n';
+    }
+    for (auto vaxd : {UNVACCINATED, VACCINATED}) {
+        for (auto strain : {NON_INFLUENZA, INFLUENZA}) {
+            summary << ledger->total_infections(vaxd, strain) << ','
+                    << ledger->total_sympt_infections(vaxd, strain) << ','
+                    << ledger->total_mai(vaxd, strain) << ',';
+        }
+    }
+    summary << ledger->total_vaccinations() << '\n';
+    return summary.str();
+}
+
+/**
+ * @brief A serial simulation of the default parameters, initialized but not yet
+ *        simulated.
+ */
+struct SerialRun {
+    SerialRun(const Tome* tome, size_t checkpoint_interval)
+        : par(&rng_handler, nullptr, tome) {
+        par.read_default_parameters(PARAMETERS);
+        simulator = std::make_unique<Simulator>(&par, nullptr, &rng_handler);
+        simulator->set_flags(FLAGS);
+        simulator->set_checkpoint_interval(checkpoint_interval);
+        simulator->init();
+    }
+
+    std::string ledger() const { return ledger_summary(simulator->get_ledger(), par.get(SIM_DURATION)); }
+
+    RngHandler rng_handler;
+    Parameters par;
+    std::unique_ptr<Simulator> simulator;
+};
+
+/**
+ * @brief An ensemble of SEEDS (serial = index) sharing the Parameters of the
+ *        first, as Storyteller::init_ensemble does, initialized but not yet
+ *        simulated.
+ */
+struct EnsembleRun {
+    EnsembleRun(const Tome* tome, size_t checkpoint_interval) {
+        std::vector<Ensemble::Realization> realizations;
+        for (size_t r = 0; r < SEEDS.size(); ++r) {
+            rng_handlers.push_back(std::make_unique<RngHandler>());
+            rng_handlers.back()->set_seed(SEEDS[r]);
+            realizations.push_back({r, rng_handlers.back().get(), nullptr});
+        }
+
+        par = std::make_unique<Parameters>(rng_handlers.front().get(), nullptr, tome);
+        par->read_default_parameters(PARAMETERS);
+
+        ensemble = std::make_unique<Ensemble>(par.get(), realizations);
+        ensemble->set_flags(FLAGS);
+        ensemble->set_checkpoint_interval(checkpoint_interval);
+        ensemble->init();
+    }
+
+    std::vector<std::unique_ptr<RngHandler>> rng_handlers;
+    std::unique_ptr<Parameters> par;
+    std::unique_ptr<Ensemble> ensemble;
+};
+
+} // namespace
+
+// the checkpoint is written at the end of the day SIGTERM arrives on, in a child
+// process since a termination request cannot be withdrawn
+TEST(ResumeTest, SerialResumesAfterSigterm) {
+    ExampleTome example("resume_serial");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    SerialRun uninterrupted(&tome, 0);
+    uninterrupted.simulator->simulate();
+    uninterrupted.simulator->results();
+    const auto ledger  = uninterrupted.ledger();
+    const auto metrics = metrics_csv(example, 0);
+    ASSERT_FALSE(metrics.empty());
+
+    GTEST_FLAG_SET(death_test_style, "fast");
+    EXPECT_EXIT({
+        checkpoint::install_termination_handler();
+        SerialRun interrupted(&tome, CHECKPOINT_INTERVAL);
+        interrupted.simulator->simulate_until(CHECKPOINT_INTERVAL);
+        std::raise(SIGTERM);
+        interrupted.simulator->simulate();
+        exit(interrupted.simulator->was_interrupted() ? checkpoint::INTERRUPTED_RETURN_CODE : 0);
+    }, testing::ExitedWithCode(checkpoint::INTERRUPTED_RETURN_CODE), "");
+    ASSERT_TRUE(fs::exists(checkpoint_file(example, 0)));
+    EXPECT_EQ(checkpoint::read_header(checkpoint_file(example, 0)).sim_time, CHECKPOINT_INTERVAL + 1);
+
+    fs::remove(example.dir() / "out" / "metrics_0.csv");
+    SerialRun resumed(&tome, CHECKPOINT_INTERVAL);
+    ASSERT_TRUE(resumed.simulator->resume());
+    resumed.simulator->simulate();
+    resumed.simulator->results();
+    EXPECT_EQ(resumed.ledger(), ledger);
+    EXPECT_EQ(metrics_csv(example, 0), metrics);
+    EXPECT_FALSE(fs::exists(checkpoint_file(example, 0)));
+}
+
+// an ensemble stopped before its results resumes from its latest periodic checkpoint
+TEST(ResumeTest, EnsembleResumesFromPeriodicCheckpoint) {
+    ExampleTome example("resume_ensemble");
+    sol::state lua_vm;
+    Tome tome(&lua_vm, example.path());
+
+    std::vector<std::string> metrics;
+    {
+        EnsembleRun uninterrupted(&tome, 0);
+        uninterrupted.ensemble->simulate();
+        uninterrupted.ensemble->results();
+        for (size_t r = 0; r < SEEDS.size(); ++r) { metrics.push_back(metrics_csv(example, r)); }
+    }
+    ASSERT_FALSE(metrics[0].empty());
+    ASSERT_NE(metrics[0], metrics[1]);
+
+    {
+        EnsembleRun interrupted(&tome, CHECKPOINT_INTERVAL);
+        interrupted.ensemble->simulate();
+    }
+    const size_t sim_duration    = PARAMETERS.at("sim_duration");
+    const size_t last_checkpoint = (sim_duration - 1) / CHECKPOINT_INTERVAL * CHECKPOINT_INTERVAL;
+    for (size_t r = 0; r < SEEDS.size(); ++r) {
+        ASSERT_TRUE(fs::exists(checkpoint_file(example, r)));
+        EXPECT_EQ(checkpoint::read_header(checkpoint_file(example, r)).sim_time, last_checkpoint);
+        fs::remove(example.dir() / "out" / ("metrics_" + std::to_string(r) + ".csv"));
+    }
+
+    EnsembleRun resumed(&tome, CHECKPOINT_INTERVAL);
+    ASSERT_TRUE(resumed.ensemble->resume());
+    resumed.ensemble->simulate();
+    resumed.ensemble->results();
+    for (size_t r = 0; r < SEEDS.size(); ++r) {
+        EXPECT_EQ(metrics_csv(example, r), metrics[r]);
+        EXPECT_FALSE(fs::exists(checkpoint_file(example, r)));
+    }
+}
+
+// a worker interrupted on its first day is rerun with --resume, as the batch would be
+TEST(ResumeTest, WorkerResumesAfterSigterm) {
+    ExampleTome example("resume_worker");
+    std::vector<std::string> args = {"storyteller", "--simulate", "--hpc", "--tome", example.path(), "--serial", "0"};
+    std::vector<char*> argv;
+    for (auto& arg : args) { argv.push_back(arg.data()); }
+    const Storyteller storyteller(argv.size(), argv.data());
+    ASSERT_NE(storyteller.get_tome(), nullptr);
+
+    RngHandler rng_handler;
+    Parameters defaults(&rng_handler, nullptr, storyteller.get_tome());
+    defaults.read_default_parameters(PARAMETERS);
+    const std::vector<ParameterSet> batch_parsets = {defaults.get_values()};
+
+    auto run_worker = [&](bool resume, size_t checkpoint_interval) {
+        std::mutex writer;
+        BatchWorker worker(&storyteller, {{"simulate", true}, {"hpc_mode", true}, {"crn", false}, {"resume", resume}},
+                           "philox", &writer);
+        worker.set_checkpoint_interval(checkpoint_interval);
+        std::vector<ParticleJob> jobs(1);
+        return worker.run(0, {0}, batch_parsets, jobs);
+    };
+
+    ASSERT_TRUE(run_worker(false, 0));
+    const auto metrics = metrics_csv(example, 0);
+    ASSERT_FALSE(metrics.empty());
+    fs::remove(example.dir() / "out" / "metrics_0.csv");
+
+    GTEST_FLAG_SET(death_test_style, "fast");
+    EXPECT_EXIT({
+        checkpoint::install_termination_handler();
+        std::raise(SIGTERM);
+        exit(run_worker(false, CHECKPOINT_INTERVAL) ? 0 : checkpoint::INTERRUPTED_RETURN_CODE);
+    }, testing::ExitedWithCode(checkpoint::INTERRUPTED_RETURN_CODE), "");
+    ASSERT_TRUE(fs::exists(checkpoint_file(example, 0)));
+    EXPECT_EQ(checkpoint::read_header(checkpoint_file(example, 0)).sim_time, size_t(1));
+    EXPECT_TRUE(metrics_csv(example, 0).empty());
+
+    ASSERT_TRUE(run_worker(true, CHECKPOINT_INTERVAL));
+    EXPECT_EQ(metrics_csv(example, 0), metrics);
+    EXPECT_FALSE(fs::exists(checkpoint_file(example, 0)));
+}
\ No newline at end of file
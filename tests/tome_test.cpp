@@ -0,0 +1,68 @@
+/**
+ * @file tome_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests that a compiled Tome is only loaded when it is intact, and that a
+ *        truncated or damaged one falls back to the Lua configs.
+ *
+ * @copyright TBD
+ */
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#define SOL_ALL_SAFETIES_ON 1
+#include <sol/sol.hpp>
+
+#include <storyteller/tome.hpp>
+
+#include "example_tome.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// compiles the example's tome and returns the path of the compiled file
+fs::path compile(const ExampleTome& example) {
+    sol::state lua_vm;
+    Tome(&lua_vm, example.path()).compile();
+    return Tome::compiled_path(fs::absolute(example.path()));
+}
+
+} // namespace
+
+TEST(TomeTest, IntactCompiledTomeIsLoaded) {
+    ExampleTome example("tome_intact");
+    compile(example);
+
+    sol::state lua_vm;
+    const auto tome = Tome::load_compiled(&lua_vm, example.path());
+    ASSERT_NE(tome, nullptr);
+    EXPECT_GT(tome->get_parameter_schema()->size(), 0u);
+}
+
+TEST(TomeTest, TruncatedCompiledTomeFallsBackToLua) {
+    ExampleTome example("tome_truncated");
+    const auto compiled = compile(example);
+    fs::resize_file(compiled, fs::file_size(compiled) / 2);
+
+    sol::state lua_vm;
+    EXPECT_EQ(Tome::load_compiled(&lua_vm, example.path()), nullptr);
+}
+
+TEST(TomeTest, DamagedCompiledTomeFallsBackToLua) {
+    ExampleTome example("tome_damaged");
+    const auto compiled = compile(example);
+    {
+        const auto middle = fs::file_size(compiled) / 2;
+        std::fstream file(compiled, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(middle);
+        const char byte = file.get();
+        file.seekp(middle);
+        file.put(byte ^ 0x01);
+    }
+
+    sol::state lua_vm;
+    EXPECT_EQ(Tome::load_compiled(&lua_vm, example.path()), nullptr);
+}
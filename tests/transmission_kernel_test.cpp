@@ -0,0 +1,110 @@
+/**
+ * @file transmission_kernel_test.cpp
+ * @author Alexander N. Pillai
+ * @brief Tests that every instruction set of the transmission kernel decides the
+ *        same outcomes as the scalar path of Person::attempt_infection.
+ *
+ * @copyright TBD
+ */
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <storyteller/transmission_kernel.hpp>
+
+namespace {
+
+/**
+ * @brief Exposures that mix susceptible, immune, vaccinated and unvaccinated
+ *        agents, with draws that exactly hit their probabilities. The size is not
+ *        a multiple of any vector width, so every ISA also runs its scalar tail.
+ */
+struct Exposures {
+    explicit Exposures(size_t n)
+        : susceptibility(n), vaccine_protection(n), pr_symptoms(n), pr_careseeking(n),
+          u_infection(n), u_symptoms(n), u_careseeking(n) {
+        std::mt19937_64 engine(2024);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (size_t i = 0; i < n; ++i) {
+            susceptibility[i]     = (i % 7 == 0) ? 0.0 : uniform(engine);
+            vaccine_protection[i] = (i % 2 == 0) ? 0.0 : uniform(engine);
+            pr_symptoms[i]        = uniform(engine);
+            pr_careseeking[i]     = (i % 11 == 0) ? 1.0 : uniform(engine);
+            u_infection[i]        = uniform(engine);
+            u_symptoms[i]         = uniform(engine);
+            u_careseeking[i]      = uniform(engine);
+
+            // draws equal to their probability must not succeed
+            if (i % 13 == 0) { u_infection[i] = susceptibility[i] * (1 - vaccine_protection[i]); }
+            if (i % 17 == 0) { u_symptoms[i] = pr_symptoms[i]; }
+            if (i % 19 == 0) { u_careseeking[i] = pr_careseeking[i]; }
+        }
+    }
+
+    std::vector<uint8_t> evaluate(KernelIsa isa) const {
+        std::vector<uint8_t> outcomes(susceptibility.size());
+        const InfectionBatch batch = {
+            susceptibility.size(), susceptibility.data(), vaccine_protection.data(), pr_symptoms.data(),
+            pr_careseeking.data(), u_infection.data(), u_symptoms.data(), u_careseeking.data(), outcomes.data()
+        };
+        transmission_kernel::evaluate(batch, isa);
+        return outcomes;
+    }
+
+    std::vector<double> susceptibility, vaccine_protection, pr_symptoms, pr_careseeking;
+    std::vector<double> u_infection, u_symptoms, u_careseeking;
+};
+
+const size_t N_EXPOSURES = 1003;
+
+std::vector<uint8_t> infection_mask(const std::vector<uint8_t>& outcomes) {
+    std::vector<uint8_t> mask;
+    for (auto o : outcomes) { mask.push_back(o & INFECTED); }
+    return mask;
+}
+
+class TransmissionKernelIsaTest : public ::testing::TestWithParam<KernelIsa> {};
+
+} // namespace
+
+// the decisions of Person::attempt_infection for a susceptible agent
+TEST(TransmissionKernelTest, ScalarMatchesAttemptInfection) {
+    const Exposures exposures(N_EXPOSURES);
+    const auto outcomes = exposures.evaluate(SCALAR);
+
+    size_t n_infected = 0;
+    for (size_t i = 0; i < N_EXPOSURES; ++i) {
+        auto current_suscep = exposures.susceptibility[i];
+        current_suscep *= 1 - exposures.vaccine_protection[i];
+        const bool infected = exposures.u_infection[i] < current_suscep;
+        ASSERT_EQ(bool(outcomes[i] & INFECTED), infected) << "exposure " << i;
+        if (not infected) { continue; }
+
+        ++n_infected;
+        const bool symptomatic = exposures.u_symptoms[i] < exposures.pr_symptoms[i];
+        const bool seek_care   = symptomatic ? exposures.u_careseeking[i] < exposures.pr_careseeking[i] : false;
+        EXPECT_EQ(bool(outcomes[i] & HAS_SYMPTOMS), symptomatic) << "exposure " << i;
+        EXPECT_EQ(bool(outcomes[i] & SEEKS_CARE), seek_care) << "exposure " << i;
+    }
+    EXPECT_GT(n_infected, size_t(0));
+    EXPECT_LT(n_infected, N_EXPOSURES);
+}
+
+TEST_P(TransmissionKernelIsaTest, MatchesScalar) {
+    const auto isa = GetParam();
+    if (not transmission_kernel::is_supported(isa)) {
+        GTEST_SKIP() << transmission_kernel::isa_name(isa) << " is not supported by this CPU";
+    }
+
+    const Exposures exposures(N_EXPOSURES);
+    const auto scalar   = exposures.evaluate(SCALAR);
+    const auto outcomes = exposures.evaluate(isa);
+    EXPECT_EQ(infection_mask(outcomes), infection_mask(scalar));
+    EXPECT_EQ(outcomes, scalar);
+}
+
+INSTANTIATE_TEST_SUITE_P(VectorIsas, TransmissionKernelIsaTest, ::testing::Values(AVX2, AVX512),
+                         [](const auto& info) { return std::string(transmission_kernel::isa_name(info.param)); });
\ No newline at end of file